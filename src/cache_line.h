@@ -0,0 +1,36 @@
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// Layout of per-lock and per-thread records that threads write independently.
+//
+// A record that shares a cache line with its neighbour makes every write to
+// one invalidate the other on the cores using it (false sharing). The
+// concurrent containers therefore pad such records to CACHE_LINE_PAD bytes,
+// declare them _Alignas(CACHE_LINE_SIZE), and allocate them with
+// _cache_line_calloc, so every record starts on a line of its own. The padding
+// is two lines because adjacent-line prefetchers pull lines in pairs.
+#define CACHE_LINE_SIZE 64
+#define CACHE_LINE_PAD (2 * CACHE_LINE_SIZE)
+
+/**
+ * @brief calloc for arrays of cache-line aligned records. Release with free().
+ * @param count Number of records.
+ * @param size Size of one record, a multiple of CACHE_LINE_SIZE.
+ * @return Zeroed memory aligned to CACHE_LINE_SIZE, or NULL on failure.
+ */
+static inline void *_cache_line_calloc(size_t count, size_t size) {
+    if (size != 0 && count > (size_t)-1 / size) {
+        return NULL;
+    }
+    size_t bytes = count * size;
+    void *memory = aligned_alloc(CACHE_LINE_SIZE, (bytes > 0) ? bytes : CACHE_LINE_SIZE);
+    if (memory != NULL) {
+        memset(memory, 0, bytes);
+    }
+    return memory;
+}
+
+#endif // CACHE_LINE_H
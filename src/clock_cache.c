@@ -0,0 +1,575 @@
+#include "clock_cache.h"
+#include "cache_line.h"
+#include "epoch.h"
+#include "hash_map_internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CLOCK_DEFAULT_SHARDS 64    // Default number of shards
+#define CLOCK_RETIRE_BATCH 32      // Entries a shard collects before handing them to epoch reclamation
+
+// A cached entry. Entries are never modified once published except for the
+// reference bit and the chain link; replacing a value swaps in a new entry.
+typedef struct clock_entry_t {
+    epoch_entry_t retire;      // Reclamation hook for evictions, replacements and deletes
+    void *key;
+    void *value;
+    uint64_t hash;             // Hash of the key under the cache's key settings
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+    size_t ring_index;         // Position in the shard's ring
+    _Atomic(struct clock_entry_t *) next; // Next entry in the same bucket
+    atomic_uchar referenced;   // Set by hits, cleared by the CLOCK hand
+} clock_entry_t;
+
+// Shard: a fixed bucket array that readers walk without locks, plus the ring
+// the CLOCK hand sweeps. The shard never holds more than ring_size entries, so
+// the buckets are sized once and never resized under a reader. Shard headers
+// sit on cache lines of their own (see cache_line.h).
+typedef union {
+    struct {
+        pthread_mutex_t lock;  // Serializes writers; readers never take it
+        _Atomic(clock_entry_t *) *buckets; // bucket_mask + 1 chain heads
+        size_t bucket_mask;    // Number of buckets minus one
+        clock_entry_t **ring;  // ring_size positions; NULL marks a free position
+        size_t ring_size;      // Entries the shard holds at most
+        size_t filled;         // Positions below this have been used at least once
+        size_t hand;           // Next position the CLOCK hand inspects
+        atomic_size_t size;    // Entries currently in the shard
+        epoch_entry_t *retired; // Unlinked entries not yet handed to epoch reclamation
+        size_t retired_count;  // Length of the retired list
+    } s;
+    _Alignas(CACHE_LINE_SIZE) char pad[CACHE_LINE_PAD];
+} clock_shard_t;
+
+struct clock_cache_t {
+    clock_shard_t *shards;
+    size_t shard_count;        // Number of shards, a power of two
+    unsigned shard_bits;       // log2(shard_count)
+    map_t *keys;               // Empty map whose settings hash and compare the keys
+    free_func_t key_free_func; // Optional: Function to free key memory
+    free_func_t value_free_func; // Optional: Function to free value memory
+};
+
+static void _clock_free_entry(epoch_entry_t *entry) {
+    clock_entry_t *cached = (clock_entry_t *)entry;
+    const clock_cache_t *cache = (const clock_cache_t *)entry->context;
+    if (cache->key_free_func && cached->key) {
+        cache->key_free_func(cached->key);
+    }
+    if (cache->value_free_func && cached->value) {
+        cache->value_free_func(cached->value);
+    }
+    free(cached);
+}
+
+// For entries replaced by a newer entry that took over their key
+static void _clock_free_entry_value(epoch_entry_t *entry) {
+    clock_entry_t *cached = (clock_entry_t *)entry;
+    const clock_cache_t *cache = (const clock_cache_t *)entry->context;
+    if (cache->value_free_func && cached->value) {
+        cache->value_free_func(cached->value);
+    }
+    free(cached);
+}
+
+/**
+ * @brief Picks a key's shard from the top bits of its mixed hash.
+ */
+static inline clock_shard_t *_clock_shard(const clock_cache_t *cache, uint64_t hash) {
+    if (cache->shard_bits == 0) {
+        return &cache->shards[0];
+    }
+    return &cache->shards[_map_mix64(hash) >> (64 - cache->shard_bits)];
+}
+
+/**
+ * @brief Returns a key's bucket within its shard, taken from the low bits of the mixed hash.
+ */
+static inline _Atomic(clock_entry_t *) *_clock_bucket(const clock_shard_t *shard, uint64_t hash) {
+    return &shard->s.buckets[(size_t)_map_mix64(hash) & shard->s.bucket_mask];
+}
+
+/**
+ * @brief Finds a key's entry without taking a lock. Caller is inside an epoch critical section.
+ * @return The entry, or NULL if the key is not cached.
+ */
+static clock_entry_t *_clock_find(const clock_cache_t *cache, const clock_shard_t *shard,
+                                  const map_lookup_t *lookup) {
+    clock_entry_t *cached = atomic_load_explicit(_clock_bucket(shard, lookup->hash), memory_order_acquire);
+    for (; cached != NULL; cached = atomic_load_explicit(&cached->next, memory_order_acquire)) {
+        if (_map_key_equals(cache->keys, cached->hash, cached->key, cached->key_len, lookup)) {
+            return cached;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds the link that points at an entry. Caller holds the shard's lock.
+ * @return Address of the link to the entry, or NULL if it is not linked.
+ */
+static _Atomic(clock_entry_t *) *_clock_find_link(const clock_cache_t *cache, clock_shard_t *shard,
+                                                  const map_lookup_t *lookup) {
+    _Atomic(clock_entry_t *) *link = _clock_bucket(shard, lookup->hash);
+    clock_entry_t *cached;
+    while ((cached = atomic_load_explicit(link, memory_order_relaxed)) != NULL) {
+        if (_map_key_equals(cache->keys, cached->hash, cached->key, cached->key_len, lookup)) {
+            return link;
+        }
+        link = &cached->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Queues an unlinked entry for reclamation. Caller holds the shard's lock.
+ * Entries are handed to epoch_retire_list in batches, so writers on different
+ * shards rarely meet on the global limbo lock.
+ * @param cache Pointer to the cache.
+ * @param shard The shard the entry was unlinked from.
+ * @param cached The entry; readers may still be looking at it.
+ * @param free_func Frees the entry once no reader can see it.
+ */
+static void _clock_defer_free(clock_cache_t *cache, clock_shard_t *shard, clock_entry_t *cached,
+                              epoch_free_func_t free_func) {
+    cached->retire.free_func = free_func;
+    cached->retire.context = cache;
+    cached->retire.next = shard->s.retired;
+    shard->s.retired = &cached->retire;
+    shard->s.retired_count++;
+}
+
+/**
+ * @brief Detaches the shard's retired list once it is a full batch. Caller holds the shard's lock.
+ * @return The batch to pass to epoch_retire_list after unlocking, or NULL.
+ */
+static epoch_entry_t *_clock_take_retired(clock_shard_t *shard) {
+    if (shard->s.retired_count < CLOCK_RETIRE_BATCH) {
+        return NULL;
+    }
+    epoch_entry_t *batch = shard->s.retired;
+    shard->s.retired = NULL;
+    shard->s.retired_count = 0;
+    return batch;
+}
+
+/**
+ * @brief Picks the ring position for a new entry, evicting one if the shard is full.
+ * Caller holds the shard's lock.
+ * @param cache Pointer to the cache.
+ * @param shard The shard.
+ * @return A free ring position.
+ */
+static size_t _clock_claim_position(clock_cache_t *cache, clock_shard_t *shard) {
+    if (shard->s.filled < shard->s.ring_size) {
+        return shard->s.filled++;
+    }
+
+    // Hits set reference bits without the lock and can keep re-marking entries
+    // behind the hand, so the sweep is capped at two laps; after that the entry
+    // under the hand goes regardless
+    for (size_t steps = 0;; steps++) {
+        size_t position = shard->s.hand;
+        shard->s.hand = (position + 1 == shard->s.ring_size) ? 0 : position + 1;
+
+        clock_entry_t *cached = shard->s.ring[position];
+        if (cached == NULL) {
+            return position; // Freed by a delete
+        }
+        if (steps < 2 * shard->s.ring_size && atomic_load_explicit(&cached->referenced, memory_order_relaxed)) {
+            atomic_store_explicit(&cached->referenced, 0, memory_order_relaxed);
+            continue;
+        }
+
+        // A reader standing on the entry can still follow its next pointer
+        map_lookup_t lookup = { cached->key, cached->key_len, cached->hash };
+        _Atomic(clock_entry_t *) *link = _clock_find_link(cache, shard, &lookup);
+        atomic_store_explicit(link, atomic_load_explicit(&cached->next, memory_order_relaxed),
+                              memory_order_release);
+        shard->s.ring[position] = NULL;
+        atomic_fetch_sub_explicit(&shard->s.size, 1, memory_order_relaxed);
+        _clock_defer_free(cache, shard, cached, _clock_free_entry);
+        return position;
+    }
+}
+
+/**
+ * @brief Creates a CLOCK cache.
+ * @param capacity Maximum number of entries.
+ * @param shards Number of shards. If 0, uses CLOCK_DEFAULT_SHARDS.
+ * @param hash_func Function to hash keys.
+ * @param compare_func Function to compare keys.
+ * @param key_free_func Optional: Function to free key memory. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory. Can be NULL.
+ * @param options Optional: Key settings. NULL selects the defaults.
+ * @return A pointer to the newly created cache, or NULL on error.
+ */
+clock_cache_t *clock_cache_create(
+    size_t capacity,
+    size_t shards,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options) {
+    if (options != NULL && (options->copy_keys || options->bloom_bits_per_key > 0)) {
+        fprintf(stderr, "MAP_FAILURE: CLOCK caches cannot use copy_keys or a Bloom filter.\n");
+        return NULL;
+    }
+    if (capacity == 0) {
+        fprintf(stderr, "MAP_FAILURE: CLOCK cache capacity cannot be 0.\n");
+        return NULL;
+    }
+
+    clock_cache_t *cache = (clock_cache_t *)calloc(1, sizeof(clock_cache_t));
+    if (cache == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate cache structure.\n");
+        return NULL;
+    }
+    cache->key_free_func = key_free_func;
+    cache->value_free_func = value_free_func;
+
+    // Validates the key settings and draws the seed of a keyed hash; holds no entries
+    cache->keys = map_create_with_options(0, hash_func, compare_func, NULL, NULL, options);
+    if (cache->keys == NULL) {
+        free(cache);
+        return NULL;
+    }
+
+    cache->shard_count = _map_round_pow2((shards > 0) ? shards : CLOCK_DEFAULT_SHARDS, 1);
+    while (cache->shard_count > 1 && cache->shard_count > capacity) {
+        cache->shard_count /= 2;
+    }
+    while (((size_t)1 << cache->shard_bits) < cache->shard_count) {
+        cache->shard_bits++;
+    }
+
+    cache->shards = (clock_shard_t *)_cache_line_calloc(cache->shard_count, sizeof(clock_shard_t));
+    if (cache->shards == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate shards.\n");
+        map_destroy(cache->keys);
+        free(cache);
+        return NULL;
+    }
+
+    size_t ring_size = (capacity + cache->shard_count - 1) / cache->shard_count;
+    size_t bucket_count = _map_round_pow2(ring_size, 1); // At most one entry per bucket on average
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        clock_shard_t *shard = &cache->shards[i];
+        pthread_mutex_init(&shard->s.lock, NULL);
+        atomic_init(&shard->s.size, 0);
+        shard->s.ring_size = ring_size;
+        shard->s.bucket_mask = bucket_count - 1;
+        shard->s.ring = (clock_entry_t **)calloc(ring_size, sizeof(clock_entry_t *));
+        shard->s.buckets = (_Atomic(clock_entry_t *) *)calloc(bucket_count, sizeof(shard->s.buckets[0]));
+        if (shard->s.ring == NULL || shard->s.buckets == NULL) {
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate cache shard.\n");
+            cache->shard_count = i + 1;
+            clock_cache_destroy(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+/**
+ * @brief Destroys the cache, freeing every entry.
+ * @param cache Pointer to the cache to destroy.
+ */
+void clock_cache_destroy(clock_cache_t *cache) {
+    if (cache == NULL) return;
+
+    epoch_barrier(); // Frees retired entries, which reference the cache
+
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        clock_shard_t *shard = &cache->shards[i];
+        // No reader is left, so entries still waiting for a batch can go right away
+        epoch_entry_t *retired = shard->s.retired;
+        while (retired != NULL) {
+            epoch_entry_t *next = retired->next;
+            retired->free_func(retired);
+            retired = next;
+        }
+        if (shard->s.ring != NULL) {
+            for (size_t j = 0; j < shard->s.filled; ++j) {
+                if (shard->s.ring[j] != NULL) {
+                    shard->s.ring[j]->retire.context = cache;
+                    _clock_free_entry(&shard->s.ring[j]->retire);
+                }
+            }
+        }
+        free(shard->s.ring);
+        free(shard->s.buckets);
+        pthread_mutex_destroy(&shard->s.lock);
+    }
+    free(cache->shards);
+    map_destroy(cache->keys);
+    free(cache);
+}
+
+/**
+ * @brief Inserts or replaces a prepared key, evicting an entry from its shard if it is full.
+ * @param cache Pointer to the cache.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure.
+ */
+static map_result_t _clock_put(clock_cache_t *cache, const map_lookup_t *lookup, void *key, void *value) {
+    clock_shard_t *shard = _clock_shard(cache, lookup->hash);
+
+    // Allocated before taking the lock, to keep the critical section short
+    clock_entry_t *cached = (clock_entry_t *)malloc(sizeof(clock_entry_t));
+    if (cached == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate cache entry.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+    cached->key = key;
+    cached->value = value;
+    cached->hash = lookup->hash;
+    cached->key_len = lookup->key_len;
+    atomic_init(&cached->referenced, 0);
+
+    pthread_mutex_lock(&shard->s.lock);
+
+    void *stored_key = key;
+    _Atomic(clock_entry_t *) *link = _clock_find_link(cache, shard, lookup);
+    if (link != NULL) {
+        // Replace: the new entry takes over the stored key and ring position, so
+        // readers see either the old pair or the new one, never a mix
+        clock_entry_t *old_entry = atomic_load_explicit(link, memory_order_relaxed);
+        stored_key = old_entry->key;
+        cached->key = stored_key;
+        cached->ring_index = old_entry->ring_index;
+        atomic_init(&cached->referenced, 1);
+        atomic_init(&cached->next, atomic_load_explicit(&old_entry->next, memory_order_relaxed));
+        atomic_store_explicit(link, cached, memory_order_release);
+        shard->s.ring[cached->ring_index] = cached;
+        _clock_defer_free(cache, shard, old_entry, _clock_free_entry_value);
+    } else {
+        size_t position = _clock_claim_position(cache, shard);
+        _Atomic(clock_entry_t *) *bucket = _clock_bucket(shard, lookup->hash);
+        cached->ring_index = position;
+        atomic_init(&cached->next, atomic_load_explicit(bucket, memory_order_relaxed));
+        atomic_store_explicit(bucket, cached, memory_order_release);
+        shard->s.ring[position] = cached;
+        atomic_fetch_add_explicit(&shard->s.size, 1, memory_order_relaxed);
+    }
+    epoch_entry_t *batch = _clock_take_retired(shard);
+
+    pthread_mutex_unlock(&shard->s.lock);
+
+    epoch_retire_list(batch);
+    // `cached` may already be replaced and freed by now, so compare with the saved key
+    if (cache->key_free_func && key != stored_key) {
+        cache->key_free_func(key); // Never published, so no grace period needed
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Retrieves a prepared key's value without taking a lock, marking its entry as used.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+static void *_clock_get(clock_cache_t *cache, const map_lookup_t *lookup) {
+    void *value = NULL;
+    epoch_enter();
+    clock_entry_t *cached = _clock_find(cache, _clock_shard(cache, lookup->hash), lookup);
+    if (cached != NULL) {
+        // Only write when the bit is clear, so hot entries stay shared in every reader's cache
+        if (!atomic_load_explicit(&cached->referenced, memory_order_relaxed)) {
+            atomic_store_explicit(&cached->referenced, 1, memory_order_relaxed);
+        }
+        value = cached->value;
+    }
+    epoch_exit();
+    return value;
+}
+
+/**
+ * @brief Checks for a prepared key without taking a lock or marking its entry.
+ * @return 1 if the key is cached, 0 otherwise.
+ */
+static int _clock_contains(clock_cache_t *cache, const map_lookup_t *lookup) {
+    epoch_enter();
+    int found = _clock_find(cache, _clock_shard(cache, lookup->hash), lookup) != NULL;
+    epoch_exit();
+    return found;
+}
+
+/**
+ * @brief Removes a prepared key. Its key and value are freed once no reader can see them.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found.
+ */
+static map_result_t _clock_delete(clock_cache_t *cache, const map_lookup_t *lookup) {
+    clock_shard_t *shard = _clock_shard(cache, lookup->hash);
+
+    pthread_mutex_lock(&shard->s.lock);
+    _Atomic(clock_entry_t *) *link = _clock_find_link(cache, shard, lookup);
+    if (link == NULL) {
+        pthread_mutex_unlock(&shard->s.lock);
+        return MAP_KEY_NOT_FOUND;
+    }
+    clock_entry_t *cached = atomic_load_explicit(link, memory_order_relaxed);
+    atomic_store_explicit(link, atomic_load_explicit(&cached->next, memory_order_relaxed), memory_order_release);
+    shard->s.ring[cached->ring_index] = NULL;
+    atomic_fetch_sub_explicit(&shard->s.size, 1, memory_order_relaxed);
+    _clock_defer_free(cache, shard, cached, _clock_free_entry);
+    epoch_entry_t *batch = _clock_take_retired(shard);
+    pthread_mutex_unlock(&shard->s.lock);
+
+    epoch_retire_list(batch);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Inserts or replaces an entry, evicting one from the key's shard if it is full.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_put(clock_cache_t *cache, void *key, void *value) {
+    if (cache == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, _map_default_key_len(cache->keys, key), &lookup);
+    return _clock_put(cache, &lookup, key, value);
+}
+
+/**
+ * @brief Like clock_cache_put, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_put_n(clock_cache_t *cache, void *key, size_t key_len, void *value) {
+    if (cache == NULL || key == NULL || cache->keys->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, key_len, &lookup);
+    return _clock_put(cache, &lookup, key, value);
+}
+
+/**
+ * @brief Retrieves a value and marks its entry as recently used.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+void *clock_cache_get(clock_cache_t *cache, const void *key) {
+    if (cache == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, _map_default_key_len(cache->keys, key), &lookup);
+    return _clock_get(cache, &lookup);
+}
+
+/**
+ * @brief Like clock_cache_get, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not cached or on invalid input.
+ */
+void *clock_cache_get_n(clock_cache_t *cache, const void *key, size_t key_len) {
+    if (cache == NULL || key == NULL || cache->keys->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, key_len, &lookup);
+    return _clock_get(cache, &lookup);
+}
+
+/**
+ * @brief Checks if a key is cached, without marking it as used.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key is cached, 0 otherwise.
+ */
+int clock_cache_contains(clock_cache_t *cache, const void *key) {
+    if (cache == NULL || key == NULL) {
+        return 0;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, _map_default_key_len(cache->keys, key), &lookup);
+    return _clock_contains(cache, &lookup);
+}
+
+/**
+ * @brief Like clock_cache_contains, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return 1 if the key is cached, 0 otherwise or on invalid input.
+ */
+int clock_cache_contains_n(clock_cache_t *cache, const void *key, size_t key_len) {
+    if (cache == NULL || key == NULL || cache->keys->key_mode != MAP_KEY_BYTES) {
+        return 0;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, key_len, &lookup);
+    return _clock_contains(cache, &lookup);
+}
+
+/**
+ * @brief Removes an entry. Its key and value are freed once no reader can see them.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_delete(clock_cache_t *cache, const void *key) {
+    if (cache == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, _map_default_key_len(cache->keys, key), &lookup);
+    return _clock_delete(cache, &lookup);
+}
+
+/**
+ * @brief Like clock_cache_delete, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_delete_n(clock_cache_t *cache, const void *key, size_t key_len) {
+    if (cache == NULL || key == NULL || cache->keys->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->keys, key, key_len, &lookup);
+    return _clock_delete(cache, &lookup);
+}
+
+/**
+ * @brief Returns the number of cached entries.
+ * @param cache Pointer to the cache.
+ * @return The number of entries.
+ */
+size_t clock_cache_size(const clock_cache_t *cache) {
+    if (cache == NULL) return 0;
+
+    size_t size = 0;
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        size += atomic_load_explicit(&cache->shards[i].s.size, memory_order_relaxed);
+    }
+    return size;
+}
@@ -0,0 +1,139 @@
+#ifndef CLOCK_CACHE_H
+#define CLOCK_CACHE_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Thread-safe bounded cache with CLOCK eviction.
+// Keys are split by hash into shards. Each shard has a fixed array of bucket
+// chains and a ring of entries. Lookups take no lock: they walk a chain with
+// atomic loads inside an epoch critical section (see epoch.h) and, on a hit,
+// only set the entry's reference bit if it is not set already, so concurrent
+// hits on hot keys write no shared memory. Writers take the shard's mutex,
+// publish entries with release stores and, once the shard is full, sweep its
+// CLOCK hand: referenced entries get their bit cleared and a second chance, the
+// first unreferenced one is evicted.
+//
+// Evicted, replaced and deleted entries are freed through epoch-based
+// reclamation, so values returned by clock_cache_get stay valid until the
+// calling thread's epoch_exit. Each shard collects such entries and hands them
+// over in batches, so writers rarely contend on the global reclamation lock.
+//
+// The plain functions treat MAP_KEY_BYTES keys as NUL-terminated strings; use
+// the _n functions for binary keys.
+typedef struct clock_cache_t clock_cache_t;
+
+/**
+ * @brief Creates a CLOCK cache.
+ * @param capacity Maximum number of entries, split evenly across the shards (rounded up to a
+ *                 multiple of the shard count).
+ * @param shards Number of shards, rounded up to a power of two and capped at the capacity.
+ *               If 0, uses a default sized for many threads.
+ * @param hash_func Function to hash keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param compare_func Function to compare keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param key_free_func Optional: Function to free key memory once an entry is gone. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory once an entry is gone. Can be NULL.
+ * @param options Optional: Key settings; only key_mode and keyed_hash apply, since shards keep
+ *                their own index. copy_keys and Bloom filters are rejected.
+ * @return A pointer to the newly created cache, or NULL on error.
+ */
+clock_cache_t *clock_cache_create(
+    size_t capacity,
+    size_t shards,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options);
+
+/**
+ * @brief Destroys the cache, freeing every entry. No other thread may be using it,
+ * and the caller must not be inside an epoch critical section.
+ * @param cache Pointer to the cache to destroy.
+ */
+void clock_cache_destroy(clock_cache_t *cache);
+
+/**
+ * @brief Inserts or replaces an entry, evicting one from the key's shard if it is full.
+ * The cache takes ownership of `key`: if the key is already cached, its value is
+ * replaced and `key` is freed through key_free_func unless it is the stored pointer.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure (the cache
+ *         then takes nothing), MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_put(clock_cache_t *cache, void *key, void *value);
+
+/**
+ * @brief Like clock_cache_put, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_put_n(clock_cache_t *cache, void *key, size_t key_len, void *value);
+
+/**
+ * @brief Retrieves a value and marks its entry as recently used.
+ * Wrap the call and every use of the result in epoch_enter() / epoch_exit() if
+ * other threads may insert into or delete from the cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+void *clock_cache_get(clock_cache_t *cache, const void *key);
+
+/**
+ * @brief Like clock_cache_get, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not cached or on invalid input.
+ */
+void *clock_cache_get_n(clock_cache_t *cache, const void *key, size_t key_len);
+
+/**
+ * @brief Checks if a key is cached, without marking it as used.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key is cached, 0 otherwise.
+ */
+int clock_cache_contains(clock_cache_t *cache, const void *key);
+
+/**
+ * @brief Like clock_cache_contains, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return 1 if the key is cached, 0 otherwise or on invalid input.
+ */
+int clock_cache_contains_n(clock_cache_t *cache, const void *key, size_t key_len);
+
+/**
+ * @brief Removes an entry. Its key and value are freed once no reader can see them.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_delete(clock_cache_t *cache, const void *key);
+
+/**
+ * @brief Like clock_cache_delete, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t clock_cache_delete_n(clock_cache_t *cache, const void *key, size_t key_len);
+
+/**
+ * @brief Returns the number of cached entries. Concurrent updates may not be reflected yet.
+ * @param cache Pointer to the cache.
+ * @return The number of entries.
+ */
+size_t clock_cache_size(const clock_cache_t *cache);
+
+#endif // CLOCK_CACHE_H
@@ -0,0 +1,364 @@
+#include "concurrent_map.h"
+#include "cache_line.h"
+#include "hash_map_internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CMAP_INITIAL_CAPACITY 64   // Default initial number of buckets
+#define CMAP_DEFAULT_STRIPES 64    // Default number of lock stripes
+#define CMAP_LOAD_FACTOR_THRESHOLD 0.75 // Grow when a stripe's share of buckets exceeds this load
+
+typedef struct cmap_node_t {
+    void *key;
+    void *value;
+    uint64_t hash;             // Cached mixed hash of the key
+    struct cmap_node_t *next;
+} cmap_node_t;
+
+// A lock stripe guards every bucket whose index has the stripe's index in its low bits.
+// Because both counts are powers of two, that mapping survives resizes. Stripes
+// sit on cache lines of their own (see cache_line.h).
+typedef union {
+    struct {
+        pthread_rwlock_t lock;
+        atomic_size_t size;    // Entries in this stripe's buckets
+    } s;
+    _Alignas(CACHE_LINE_SIZE) char pad[CACHE_LINE_PAD];
+} cmap_stripe_t;
+
+struct cmap_t {
+    cmap_node_t **buckets;     // Array of pointers to linked list heads (buckets)
+    size_t capacity;           // Number of buckets, a power of two and a multiple of stripe_count
+    cmap_stripe_t *stripes;
+    size_t stripe_count;       // Number of stripes, a power of two
+    hash_func_t hash_func;     // Function to hash keys
+    compare_func_t compare_func; // Function to compare keys
+    free_func_t key_free_func; // Optional: Function to free key memory
+    free_func_t value_free_func; // Optional: Function to free value memory
+};
+
+static inline uint64_t _cmap_hash(const cmap_t *map, const void *key) {
+    return _map_mix64((uint64_t)map->hash_func(key));
+}
+
+static inline cmap_stripe_t *_cmap_stripe(const cmap_t *map, uint64_t hash) {
+    return &map->stripes[(size_t)hash & (map->stripe_count - 1)];
+}
+
+/**
+ * @brief Finds the link that points at a key's node. Caller holds the key's stripe lock.
+ * @return Address of the pointer to the node, or NULL if the key is not found.
+ */
+static cmap_node_t **_cmap_find_link(const cmap_t *map, const void *key, uint64_t hash) {
+    cmap_node_t **link = &map->buckets[(size_t)hash & (map->capacity - 1)];
+    for (; *link != NULL; link = &(*link)->next) {
+        if ((*link)->hash == hash && map->compare_func((*link)->key, key) == 0) {
+            return link;
+        }
+    }
+    return NULL;
+}
+
+static void _cmap_lock_all(cmap_t *map) {
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_rwlock_wrlock(&map->stripes[i].s.lock);
+    }
+}
+
+static void _cmap_unlock_all(cmap_t *map) {
+    for (size_t i = map->stripe_count; i > 0; --i) {
+        pthread_rwlock_unlock(&map->stripes[i - 1].s.lock);
+    }
+}
+
+/**
+ * @brief Doubles the bucket array, unless another thread already grew it.
+ * Takes every stripe lock in index order, which is the only place more than one
+ * stripe lock is held for writing, so it cannot deadlock with single-stripe writers.
+ * @param map Pointer to the map.
+ * @param seen_capacity Capacity observed by the caller when it decided to grow.
+ */
+static void _cmap_grow(cmap_t *map, size_t seen_capacity) {
+    _cmap_lock_all(map);
+
+    if (map->capacity == seen_capacity) {
+        size_t new_capacity = map->capacity * 2;
+        cmap_node_t **new_buckets = (cmap_node_t **)calloc(new_capacity, sizeof(cmap_node_t *));
+        if (new_buckets == NULL) {
+            // Keep running at a higher load; the next insert will try again
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate new buckets for resize.\n");
+        } else {
+            for (size_t i = 0; i < map->capacity; ++i) {
+                cmap_node_t *current = map->buckets[i];
+                while (current != NULL) {
+                    cmap_node_t *next_node = current->next;
+                    size_t index = (size_t)current->hash & (new_capacity - 1);
+                    current->next = new_buckets[index];
+                    new_buckets[index] = current;
+                    current = next_node;
+                }
+            }
+            free(map->buckets);
+            map->buckets = new_buckets;
+            map->capacity = new_capacity;
+        }
+    }
+
+    _cmap_unlock_all(map);
+}
+
+/**
+ * @brief Creates a concurrent map.
+ * @param initial_capacity The initial number of buckets. If 0, uses CMAP_INITIAL_CAPACITY.
+ * @param stripes Number of lock stripes, rounded up to a power of two. If 0, uses CMAP_DEFAULT_STRIPES.
+ * @param hash_func Function to hash keys. MUST NOT be NULL.
+ * @param compare_func Function to compare keys. MUST NOT be NULL.
+ * @param key_free_func Optional: Function to free key memory. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory. Can be NULL.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+cmap_t *cmap_create(
+    size_t initial_capacity,
+    size_t stripes,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func) {
+    if (hash_func == NULL || compare_func == NULL) {
+        fprintf(stderr, "MAP_FAILURE: Hash function and compare function cannot be NULL.\n");
+        return NULL;
+    }
+
+    cmap_t *map = (cmap_t *)calloc(1, sizeof(cmap_t));
+    if (map == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map structure.\n");
+        return NULL;
+    }
+
+    map->stripe_count = _map_round_pow2((stripes > 0) ? stripes : CMAP_DEFAULT_STRIPES, 1);
+    map->capacity = _map_round_pow2((initial_capacity > 0) ? initial_capacity : CMAP_INITIAL_CAPACITY,
+                                    map->stripe_count);
+    map->hash_func = hash_func;
+    map->compare_func = compare_func;
+    map->key_free_func = key_free_func;
+    map->value_free_func = value_free_func;
+
+    map->buckets = (cmap_node_t **)calloc(map->capacity, sizeof(cmap_node_t *));
+    map->stripes = (cmap_stripe_t *)_cache_line_calloc(map->stripe_count, sizeof(cmap_stripe_t));
+    if (map->buckets == NULL || map->stripes == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map buckets.\n");
+        free(map->buckets);
+        free(map->stripes);
+        free(map);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_rwlock_init(&map->stripes[i].s.lock, NULL);
+        atomic_init(&map->stripes[i].s.size, 0);
+    }
+    return map;
+}
+
+/**
+ * @brief Destroys the map and frees all associated memory.
+ * @param map Pointer to the map to destroy.
+ */
+void cmap_destroy(cmap_t *map) {
+    if (map == NULL) return;
+
+    for (size_t i = 0; i < map->capacity; ++i) {
+        cmap_node_t *current = map->buckets[i];
+        while (current != NULL) {
+            cmap_node_t *next_node = current->next;
+            if (map->key_free_func && current->key) {
+                map->key_free_func(current->key);
+            }
+            if (map->value_free_func && current->value) {
+                map->value_free_func(current->value);
+            }
+            free(current);
+            current = next_node;
+        }
+    }
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_rwlock_destroy(&map->stripes[i].s.lock);
+    }
+    free(map->stripes);
+    free(map->buckets);
+    free(map);
+}
+
+/**
+ * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t cmap_insert(cmap_t *map, void *key, void *value) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    uint64_t hash = _cmap_hash(map, key);
+    cmap_stripe_t *stripe = _cmap_stripe(map, hash);
+    pthread_rwlock_wrlock(&stripe->s.lock);
+
+    cmap_node_t **link = _cmap_find_link(map, key, hash);
+    if (link != NULL) {
+        cmap_node_t *current = *link;
+        // Same replacement rules as map_insert
+        if (map->value_free_func && current->value) {
+            map->value_free_func(current->value);
+        }
+        if (map->key_free_func && current->key != key) {
+            map->key_free_func(current->key);
+        }
+        current->key = key;
+        current->value = value;
+        pthread_rwlock_unlock(&stripe->s.lock);
+        return MAP_SUCCESS;
+    }
+
+    cmap_node_t *node = (cmap_node_t *)malloc(sizeof(cmap_node_t));
+    if (node == NULL) {
+        pthread_rwlock_unlock(&stripe->s.lock);
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map node.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+    size_t index = (size_t)hash & (map->capacity - 1);
+    node->key = key;
+    node->value = value;
+    node->hash = hash;
+    node->next = map->buckets[index];
+    map->buckets[index] = node;
+
+    // Each stripe owns capacity / stripe_count buckets; judge the load on that share
+    size_t stripe_size = atomic_load_explicit(&stripe->s.size, memory_order_relaxed) + 1;
+    atomic_store_explicit(&stripe->s.size, stripe_size, memory_order_relaxed);
+    size_t capacity = map->capacity;
+    int needs_grow = (double)stripe_size / (capacity / map->stripe_count) > CMAP_LOAD_FACTOR_THRESHOLD;
+    pthread_rwlock_unlock(&stripe->s.lock);
+
+    if (needs_grow) {
+        _cmap_grow(map, capacity);
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *cmap_get(cmap_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    uint64_t hash = _cmap_hash(map, key);
+    cmap_stripe_t *stripe = _cmap_stripe(map, hash);
+    pthread_rwlock_rdlock(&stripe->s.lock);
+    cmap_node_t **link = _cmap_find_link(map, key, hash);
+    void *value = (link != NULL) ? (*link)->value : NULL;
+    pthread_rwlock_unlock(&stripe->s.lock);
+    return value;
+}
+
+/**
+ * @brief Checks if a key exists in the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int cmap_contains(cmap_t *map, const void *key) {
+    return cmap_get(map, key) != NULL;
+}
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t cmap_delete(cmap_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    uint64_t hash = _cmap_hash(map, key);
+    cmap_stripe_t *stripe = _cmap_stripe(map, hash);
+    pthread_rwlock_wrlock(&stripe->s.lock);
+
+    cmap_node_t **link = _cmap_find_link(map, key, hash);
+    if (link == NULL) {
+        pthread_rwlock_unlock(&stripe->s.lock);
+        return MAP_KEY_NOT_FOUND;
+    }
+    cmap_node_t *current = *link;
+    *link = current->next;
+    atomic_store_explicit(&stripe->s.size,
+                          atomic_load_explicit(&stripe->s.size, memory_order_relaxed) - 1,
+                          memory_order_relaxed);
+    pthread_rwlock_unlock(&stripe->s.lock);
+
+    // Free outside the lock; the node is no longer reachable
+    if (map->key_free_func && current->key) {
+        map->key_free_func(current->key);
+    }
+    if (map->value_free_func && current->value) {
+        map->value_free_func(current->value);
+    }
+    free(current);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Returns the number of key-value pairs in the map.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t cmap_size(cmap_t *map) {
+    if (map == NULL) return 0;
+
+    size_t size = 0;
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        size += atomic_load_explicit(&map->stripes[i].s.size, memory_order_relaxed);
+    }
+    return size;
+}
+
+/**
+ * @brief Iterates over all key-value pairs while holding every stripe's read lock.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t cmap_iterate(cmap_t *map, map_iter_func_t callback_func, void *user_data) {
+    if (map == NULL || callback_func == NULL) {
+        return MAP_FAILURE;
+    }
+
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_rwlock_rdlock(&map->stripes[i].s.lock);
+    }
+
+    map_result_t res = MAP_SUCCESS;
+    for (size_t i = 0; i < map->capacity && res == MAP_SUCCESS; ++i) {
+        for (cmap_node_t *current = map->buckets[i]; current != NULL; current = current->next) {
+            if (callback_func(current->key, current->value, user_data) != 0) {
+                res = MAP_FAILURE; // Callback requested to stop iteration
+                break;
+            }
+        }
+    }
+
+    _cmap_unlock_all(map);
+    return res;
+}
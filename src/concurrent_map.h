@@ -0,0 +1,93 @@
+#ifndef CONCURRENT_MAP_H
+#define CONCURRENT_MAP_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Thread-safe hash map with lock striping.
+// Buckets are partitioned into stripes, each guarded by its own reader-writer
+// lock, so lookups in different stripes never contend and lookups in the same
+// stripe share the lock. A resize takes every stripe lock in order.
+// Uses the same hash/compare/free hooks as map_t.
+typedef struct cmap_t cmap_t;
+
+/**
+ * @brief Creates a concurrent map.
+ * @param initial_capacity The initial number of buckets. If 0, uses a default.
+ * @param stripes Number of lock stripes, rounded up to a power of two. If 0, uses a default.
+ * @param hash_func Function to hash keys. MUST NOT be NULL.
+ * @param compare_func Function to compare keys. MUST NOT be NULL.
+ * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+cmap_t *cmap_create(
+    size_t initial_capacity,
+    size_t stripes,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func);
+
+/**
+ * @brief Destroys the map. No other thread may be using it.
+ * @param map Pointer to the map to destroy.
+ */
+void cmap_destroy(cmap_t *map);
+
+/**
+ * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t cmap_insert(cmap_t *map, void *key, void *value);
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * The map only guards its own structure: if another thread may update or delete
+ * the key concurrently and the map frees values, the caller must coordinate
+ * before dereferencing the result.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *cmap_get(cmap_t *map, const void *key);
+
+/**
+ * @brief Checks if a key exists in the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int cmap_contains(cmap_t *map, const void *key);
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t cmap_delete(cmap_t *map, const void *key);
+
+/**
+ * @brief Returns the number of key-value pairs in the map.
+ * Exact when no writer is active; otherwise a snapshot that may be slightly stale.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t cmap_size(cmap_t *map);
+
+/**
+ * @brief Iterates over all key-value pairs while holding every stripe's read lock.
+ * The callback must not modify the map.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t cmap_iterate(cmap_t *map, map_iter_func_t callback_func, void *user_data);
+
+#endif // CONCURRENT_MAP_H
@@ -0,0 +1,202 @@
+#include "epoch.h"
+#include "cache_line.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define EPOCH_LIMBO_LISTS 3        // Current epoch, previous epoch, and the one being freed
+#define EPOCH_ADVANCE_THRESHOLD 64 // Retirements between attempts to advance the epoch
+
+// Per-thread record, on cache lines of its own (see cache_line.h). Only its
+// owner writes state; advancing threads read it.
+typedef union epoch_record_t {
+    struct {
+        _Atomic uint64_t state;    // (observed epoch << 1) | 1 while in a critical section, else 0
+        atomic_int in_use;         // Non-zero while a live thread owns the record
+        unsigned depth;            // Nesting depth of epoch_enter, owner only
+        union epoch_record_t *next; // Next record in the global list
+    } s;
+    _Alignas(CACHE_LINE_SIZE) char pad[CACHE_LINE_PAD];
+} epoch_record_t;
+
+static _Atomic uint64_t g_epoch = 1;
+static _Atomic(epoch_record_t *) g_records = NULL; // Records are never freed, only recycled
+
+static pthread_mutex_t g_limbo_lock = PTHREAD_MUTEX_INITIALIZER;
+static epoch_entry_t *g_limbo[EPOCH_LIMBO_LISTS]; // Retired entries, indexed by epoch % 3
+static size_t g_retired_since_advance;
+
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_record_key; // Only used for its destructor, which recycles the record
+static _Thread_local epoch_record_t *t_record;
+
+static void _epoch_release_record(void *data) {
+    epoch_record_t *record = (epoch_record_t *)data;
+    record->s.depth = 0;
+    atomic_store_explicit(&record->s.state, 0, memory_order_release);
+    atomic_store_explicit(&record->s.in_use, 0, memory_order_release);
+}
+
+static void _epoch_create_key(void) {
+    pthread_key_create(&g_record_key, _epoch_release_record);
+}
+
+/**
+ * @brief Returns the calling thread's record, claiming or allocating one on first use.
+ */
+static epoch_record_t *_epoch_record(void) {
+    if (t_record != NULL) {
+        return t_record;
+    }
+    pthread_once(&g_key_once, _epoch_create_key);
+
+    epoch_record_t *record = atomic_load_explicit(&g_records, memory_order_acquire);
+    for (; record != NULL; record = record->s.next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&record->s.in_use, &expected, 1)) {
+            break; // Recycled from a thread that has exited
+        }
+    }
+
+    if (record == NULL) {
+        record = (epoch_record_t *)_cache_line_calloc(1, sizeof(epoch_record_t));
+        if (record == NULL) {
+            // A reader cannot proceed safely without a record
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate epoch record.\n");
+            abort();
+        }
+        atomic_init(&record->s.state, 0);
+        atomic_init(&record->s.in_use, 1);
+        epoch_record_t *head = atomic_load_explicit(&g_records, memory_order_relaxed);
+        do {
+            record->s.next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&g_records, &head, record,
+                                                        memory_order_release, memory_order_relaxed));
+    }
+
+    pthread_setspecific(g_record_key, record);
+    t_record = record;
+    return record;
+}
+
+void epoch_enter(void) {
+    epoch_record_t *record = _epoch_record();
+    if (record->s.depth++ > 0) {
+        return;
+    }
+    uint64_t epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+    atomic_store_explicit(&record->s.state, (epoch << 1) | 1, memory_order_relaxed);
+    // Publish the record before any shared pointer is loaded
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+void epoch_exit(void) {
+    epoch_record_t *record = t_record;
+    if (record == NULL || record->s.depth == 0) {
+        return;
+    }
+    if (--record->s.depth == 0) {
+        atomic_store_explicit(&record->s.state, 0, memory_order_release);
+    }
+}
+
+/**
+ * @brief Advances the epoch if every active thread has observed the current one.
+ * Caller holds g_limbo_lock.
+ * @return Entries that are now safe to free, or NULL. Sets *advanced.
+ */
+static epoch_entry_t *_epoch_try_advance(int *advanced) {
+    uint64_t epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    epoch_record_t *record = atomic_load_explicit(&g_records, memory_order_acquire);
+    for (; record != NULL; record = record->s.next) {
+        uint64_t state = atomic_load_explicit(&record->s.state, memory_order_acquire);
+        if ((state & 1) && (state >> 1) != epoch) {
+            *advanced = 0;
+            return NULL; // A reader may still hold pointers from the previous epoch
+        }
+    }
+
+    atomic_store_explicit(&g_epoch, epoch + 1, memory_order_release);
+    g_retired_since_advance = 0;
+    *advanced = 1;
+
+    // Every active reader has observed epoch, so nothing retired in epoch - 2 is reachable.
+    // That is the list epoch + 1 will reuse.
+    size_t index = (size_t)((epoch + 1) % EPOCH_LIMBO_LISTS);
+    epoch_entry_t *reclaimable = g_limbo[index];
+    g_limbo[index] = NULL;
+    return reclaimable;
+}
+
+static void _epoch_free_list(epoch_entry_t *entry) {
+    while (entry != NULL) {
+        epoch_entry_t *next_entry = entry->next;
+        entry->free_func(entry);
+        entry = next_entry;
+    }
+}
+
+/**
+ * @brief Adds a chain of retired entries to the current epoch's limbo list.
+ * @param first First entry of the chain.
+ * @param last Last entry of the chain.
+ * @param count Number of entries in the chain.
+ */
+static void _epoch_limbo_append(epoch_entry_t *first, epoch_entry_t *last, size_t count) {
+    epoch_entry_t *reclaimable = NULL;
+    pthread_mutex_lock(&g_limbo_lock);
+    size_t index = (size_t)(atomic_load_explicit(&g_epoch, memory_order_relaxed) % EPOCH_LIMBO_LISTS);
+    last->next = g_limbo[index];
+    g_limbo[index] = first;
+    g_retired_since_advance += count;
+    if (g_retired_since_advance >= EPOCH_ADVANCE_THRESHOLD) {
+        int advanced;
+        reclaimable = _epoch_try_advance(&advanced);
+    }
+    pthread_mutex_unlock(&g_limbo_lock);
+
+    // Free outside the lock; free functions may be slow
+    _epoch_free_list(reclaimable);
+}
+
+void epoch_retire(epoch_entry_t *entry, epoch_free_func_t free_func, void *context) {
+    entry->free_func = free_func;
+    entry->context = context;
+    _epoch_limbo_append(entry, entry, 1);
+}
+
+void epoch_retire_list(epoch_entry_t *first) {
+    if (first == NULL) return;
+
+    // Walked before taking the lock, which is then held once for the whole chain
+    epoch_entry_t *last = first;
+    size_t count = 1;
+    while (last->next != NULL) {
+        last = last->next;
+        count++;
+    }
+    _epoch_limbo_append(first, last, count);
+}
+
+void epoch_barrier(void) {
+    // Entries retired in the current epoch are freed by the third advance from now
+    for (int advances = 0; advances < EPOCH_LIMBO_LISTS;) {
+        int advanced;
+        pthread_mutex_lock(&g_limbo_lock);
+        epoch_entry_t *reclaimable = _epoch_try_advance(&advanced);
+        pthread_mutex_unlock(&g_limbo_lock);
+
+        _epoch_free_list(reclaimable);
+        if (advanced) {
+            advances++;
+        } else {
+            sched_yield(); // Wait for lagging readers to leave their critical sections
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+// Epoch-based reclamation (EBR) for lock-free readers.
+//
+// Readers bracket every access to shared nodes with epoch_enter / epoch_exit.
+// Writers unlink a node and hand it to epoch_retire instead of freeing it; the
+// node is freed once every thread that might still see it has left its critical
+// section. Readers never block and never write shared memory other than their
+// own per-thread record.
+//
+// There is one process-wide epoch. Threads register themselves on their first
+// epoch_enter; their record is recycled when the thread exits.
+
+#include <stddef.h>
+
+typedef struct epoch_entry_t epoch_entry_t;
+
+// Called once the retired object can no longer be reached by any reader.
+typedef void (*epoch_free_func_t)(epoch_entry_t *entry);
+
+// Reclamation hook, embedded in the object to be retired.
+struct epoch_entry_t {
+    epoch_entry_t *next;       // Next entry in its limbo list
+    epoch_free_func_t free_func; // Frees the object containing this entry
+    void *context;             // Free for use by free_func
+};
+
+/**
+ * @brief Starts a read-side critical section on the calling thread.
+ * Critical sections nest. Pointers loaded inside one stay valid until the
+ * outermost epoch_exit.
+ */
+void epoch_enter(void);
+
+/**
+ * @brief Ends a read-side critical section on the calling thread.
+ */
+void epoch_exit(void);
+
+/**
+ * @brief Defers freeing an object until no reader can reach it.
+ * The object must already be unreachable for readers that start afterwards.
+ * @param entry Reclamation hook embedded in the object.
+ * @param free_func Function that frees the object.
+ * @param context Stored in entry->context for free_func.
+ */
+void epoch_retire(epoch_entry_t *entry, epoch_free_func_t free_func, void *context);
+
+/**
+ * @brief Retires a chain of objects at once, taking the global limbo lock once.
+ * Writers that retire often collect their objects first and hand them over in
+ * batches. Every object must already be unreachable for new readers, and its
+ * free_func and context must be set.
+ * @param first First entry of a chain linked through entry->next, or NULL.
+ */
+void epoch_retire_list(epoch_entry_t *first);
+
+/**
+ * @brief Waits until every object retired so far has been freed.
+ * Must not be called inside a critical section.
+ */
+void epoch_barrier(void);
+
+#endif // EPOCH_H
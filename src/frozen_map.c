@@ -0,0 +1,432 @@
+#include "frozen_map.h"
+#include "hash_map_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FROZEN_KEYS_PER_BUCKET 4   // Average keys per displacement bucket
+#define FROZEN_MAX_D0 64           // Multipliers tried per bucket before giving up on a seed
+#define FROZEN_MAX_SEEDS 8         // Seeds tried before map_freeze fails
+
+// Entry of the frozen map, one per slot.
+typedef struct {
+    void *key;
+    void *value;
+    uint64_t hash;             // _map_hash_key of the key in the original map
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+} frozen_entry_t;
+
+// Displacement of one bucket: its keys go to (f1 + d0 * f2 + d1) mod size.
+typedef struct {
+    uint32_t d0;
+    uint32_t d1;
+} frozen_pilot_t;
+
+struct frozen_map_t {
+    frozen_entry_t *entries;   // size slots, all full
+    size_t size;               // Number of key-value pairs
+    frozen_pilot_t *pilots;    // bucket_count displacements
+    size_t bucket_count;
+    uint64_t seed;             // Seed the displacements were found with
+    hash_func_t hash_func;     // Function to hash keys
+    compare_func_t compare_func; // Function to compare keys
+    map_key_mode_t key_mode;   // How keys are hashed and compared
+    int mix_hash;              // Same as the original map, so cached hashes stay valid
+    int keyed_hash;            // Same as the original map
+    uint64_t hash_seed[2];     // Seed of the original map's keyed hash
+    free_func_t key_free_func; // Optional: Function to free key memory
+    free_func_t value_free_func; // Optional: Function to free value memory
+    map_key_arena_t key_arena; // Keys taken over from a copy_keys map
+};
+
+// Per-key values derived from a hash and a seed.
+typedef struct {
+    uint32_t bucket;
+    uint32_t f1;
+    uint32_t f2;
+} frozen_derived_t;
+
+static inline frozen_derived_t _frozen_derive(uint64_t hash, uint64_t seed, size_t bucket_count, size_t size) {
+    frozen_derived_t derived;
+    uint64_t x = _map_mix64(hash ^ seed);
+    uint64_t y = _map_mix64(x ^ 0x9e3779b97f4a7c15ULL);
+    // Multiply-shift maps the top 32 bits onto [0, bucket_count) without a division
+    derived.bucket = (uint32_t)(((x >> 32) * (uint64_t)bucket_count) >> 32);
+    derived.f1 = (uint32_t)((x & 0xffffffffULL) % size);
+    derived.f2 = (uint32_t)(y % size);
+    return derived;
+}
+
+static inline size_t _frozen_slot(const frozen_derived_t *derived, frozen_pilot_t pilot, size_t size) {
+    uint64_t displaced = (uint64_t)pilot.d0 * derived->f2 % size;
+    return (size_t)(((uint64_t)derived->f1 + displaced + pilot.d1) % size);
+}
+
+// Scratch buffers of one build attempt.
+typedef struct {
+    frozen_derived_t *derived; // Per key
+    size_t *bucket_start;      // bucket_count + 1 boundaries into members
+    uint32_t *members;         // Key indexes grouped by bucket
+    uint32_t *by_size;         // Bucket indexes, largest bucket first
+    unsigned char *taken;      // Per slot, non-zero once a key has been placed there
+    size_t *size_start;        // Counting sort of buckets by size
+    size_t *slots;             // Slots of the bucket being placed
+} frozen_scratch_t;
+
+/**
+ * @brief Groups keys by bucket and orders the buckets, largest first.
+ * @return The size of the largest bucket.
+ */
+static size_t _frozen_group(const frozen_map_t *frozen, const frozen_entry_t *source, frozen_scratch_t *scratch) {
+    size_t n = frozen->size;
+    size_t buckets = frozen->bucket_count;
+    size_t *bucket_start = scratch->bucket_start;
+
+    // Counting sort of keys by bucket
+    size_t max_bucket_size = 0;
+    for (size_t i = 0; i < n; ++i) {
+        scratch->derived[i] = _frozen_derive(source[i].hash, frozen->seed, buckets, n);
+        bucket_start[scratch->derived[i].bucket + 1]++;
+    }
+    for (size_t b = 0; b < buckets; ++b) {
+        if (bucket_start[b + 1] > max_bucket_size) {
+            max_bucket_size = bucket_start[b + 1];
+        }
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        scratch->members[bucket_start[scratch->derived[i].bucket]++] = (uint32_t)i;
+    }
+    // Each start has advanced to the next bucket's start; shift them back
+    memmove(bucket_start + 1, bucket_start, buckets * sizeof(size_t));
+    bucket_start[0] = 0;
+    return max_bucket_size;
+}
+
+/**
+ * @brief Tries to find displacements for every bucket with the current seed.
+ * Buckets are placed largest first, while the table is still empty enough for
+ * them; single-key buckets come last and take the remaining free slots directly.
+ * @param frozen The frozen map; size, bucket_count and seed must be set.
+ * @param source Entries to place.
+ * @param scratch Zeroed scratch buffers.
+ * @return MAP_SUCCESS if every key got its own slot (entries and pilots are then filled in),
+ *         MAP_FAILURE if this seed does not work, MAP_ALLOCATION_ERROR on failure.
+ */
+static map_result_t _frozen_place(frozen_map_t *frozen, const frozen_entry_t *source, frozen_scratch_t *scratch) {
+    size_t n = frozen->size;
+    size_t buckets = frozen->bucket_count;
+    const frozen_derived_t *derived = scratch->derived;
+    const size_t *bucket_start = scratch->bucket_start;
+    size_t max_bucket_size = _frozen_group(frozen, source, scratch);
+
+    scratch->slots = (size_t *)malloc(max_bucket_size * sizeof(size_t));
+    scratch->size_start = (size_t *)calloc(max_bucket_size + 2, sizeof(size_t));
+    if (scratch->slots == NULL || scratch->size_start == NULL) {
+        return MAP_ALLOCATION_ERROR;
+    }
+    size_t *slots = scratch->slots;
+    size_t *size_start = scratch->size_start;
+
+    // Counting sort of buckets by descending size
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t count = bucket_start[b + 1] - bucket_start[b];
+        size_start[max_bucket_size - count + 1]++;
+    }
+    for (size_t s = 0; s <= max_bucket_size; ++s) {
+        size_start[s + 1] += size_start[s];
+    }
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t count = bucket_start[b + 1] - bucket_start[b];
+        scratch->by_size[size_start[max_bucket_size - count]++] = (uint32_t)b;
+    }
+
+    memset(frozen->pilots, 0, buckets * sizeof(frozen_pilot_t));
+    size_t free_cursor = 0;
+    for (size_t k = 0; k < buckets; ++k) {
+        size_t b = scratch->by_size[k];
+        const uint32_t *keys = scratch->members + bucket_start[b];
+        size_t count = bucket_start[b + 1] - bucket_start[b];
+        frozen_pilot_t pilot = { 0, 0 };
+
+        if (count == 0) {
+            break; // Only empty buckets follow
+        }
+
+        if (count == 1) {
+            // Any free slot can be reached with d0 = 0 and the right d1
+            while (scratch->taken[free_cursor]) {
+                free_cursor++;
+            }
+            pilot.d1 = (uint32_t)((free_cursor + n - derived[keys[0]].f1) % n);
+            slots[0] = free_cursor;
+        } else {
+            // Keys sharing f1 and f2 always collide; only another seed can split them
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = i + 1; j < count; ++j) {
+                    if (derived[keys[i]].f1 == derived[keys[j]].f1 && derived[keys[i]].f2 == derived[keys[j]].f2) {
+                        return MAP_FAILURE;
+                    }
+                }
+            }
+
+            int found = 0;
+            for (uint32_t d0 = 0; d0 < FROZEN_MAX_D0 && !found; ++d0) {
+                for (size_t d1 = 0; d1 < n && !found; ++d1) {
+                    pilot.d0 = d0;
+                    pilot.d1 = (uint32_t)d1;
+                    size_t placed = 0;
+                    for (; placed < count; ++placed) {
+                        size_t slot = _frozen_slot(&derived[keys[placed]], pilot, n);
+                        if (scratch->taken[slot]) break;
+                        size_t other = 0;
+                        while (other < placed && slots[other] != slot) other++;
+                        if (other < placed) break;
+                        slots[placed] = slot;
+                    }
+                    found = (placed == count);
+                }
+            }
+            if (!found) {
+                return MAP_FAILURE;
+            }
+        }
+
+        frozen->pilots[b] = pilot;
+        for (size_t i = 0; i < count; ++i) {
+            scratch->taken[slots[i]] = 1;
+            frozen->entries[slots[i]] = source[keys[i]];
+        }
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Runs one build attempt with the current seed.
+ * @return MAP_SUCCESS, MAP_FAILURE if this seed does not work, or MAP_ALLOCATION_ERROR.
+ */
+static map_result_t _frozen_build(frozen_map_t *frozen, const frozen_entry_t *source) {
+    size_t n = frozen->size;
+    frozen_scratch_t scratch = {0};
+    scratch.derived = (frozen_derived_t *)malloc(n * sizeof(frozen_derived_t));
+    scratch.bucket_start = (size_t *)calloc(frozen->bucket_count + 1, sizeof(size_t));
+    scratch.members = (uint32_t *)malloc(n * sizeof(uint32_t));
+    scratch.by_size = (uint32_t *)malloc(frozen->bucket_count * sizeof(uint32_t));
+    scratch.taken = (unsigned char *)calloc(n, 1);
+
+    map_result_t res = MAP_ALLOCATION_ERROR;
+    if (scratch.derived != NULL && scratch.bucket_start != NULL && scratch.members != NULL &&
+        scratch.by_size != NULL && scratch.taken != NULL) {
+        res = _frozen_place(frozen, source, &scratch);
+    }
+
+    free(scratch.derived);
+    free(scratch.bucket_start);
+    free(scratch.members);
+    free(scratch.by_size);
+    free(scratch.taken);
+    free(scratch.size_start);
+    free(scratch.slots);
+    return res;
+}
+
+/**
+ * @brief Turns a map into an immutable frozen map.
+ * @param map Pointer to the map to freeze.
+ * @return A pointer to the frozen map, or NULL on error.
+ */
+frozen_map_t *map_freeze(map_t *map) {
+    if (map == NULL) {
+        return NULL;
+    }
+    if (map->size >= UINT32_MAX) {
+        fprintf(stderr, "MAP_FAILURE: Map is too large to freeze.\n");
+        return NULL;
+    }
+
+    frozen_map_t *frozen = (frozen_map_t *)calloc(1, sizeof(frozen_map_t));
+    if (frozen == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate frozen map structure.\n");
+        return NULL;
+    }
+    frozen->size = map->size;
+    frozen->bucket_count = map->size / FROZEN_KEYS_PER_BUCKET + 1;
+    frozen->hash_func = map->hash_func;
+    frozen->compare_func = map->compare_func;
+    frozen->key_mode = map->key_mode;
+    frozen->mix_hash = map->mix_hash;
+    frozen->keyed_hash = map->keyed_hash;
+    frozen->hash_seed[0] = map->hash_seed[0];
+    frozen->hash_seed[1] = map->hash_seed[1];
+    frozen->key_free_func = map->key_free_func;
+    frozen->value_free_func = map->value_free_func;
+
+    frozen_entry_t *source = (frozen_entry_t *)malloc((frozen->size + 1) * sizeof(frozen_entry_t));
+    frozen->entries = (frozen_entry_t *)malloc((frozen->size + 1) * sizeof(frozen_entry_t));
+    frozen->pilots = (frozen_pilot_t *)calloc(frozen->bucket_count, sizeof(frozen_pilot_t));
+    map_result_t res = MAP_ALLOCATION_ERROR;
+    if (source != NULL && frozen->entries != NULL && frozen->pilots != NULL) {
+        map_iter_t it;
+        size_t count = 0;
+        map_iter_begin(map, &it);
+        while (map_iter_next(&it)) {
+            frozen_entry_t entry = { (void *)it.key, it.value, it.hash, it.key_len };
+            source[count++] = entry;
+        }
+        map_iter_end(&it);
+
+        res = MAP_FAILURE;
+        for (uint64_t attempt = 0; attempt < FROZEN_MAX_SEEDS && res == MAP_FAILURE; ++attempt) {
+            frozen->seed = _map_mix64(attempt + 1);
+            res = (frozen->size > 0) ? _frozen_build(frozen, source) : MAP_SUCCESS;
+        }
+    }
+    free(source);
+
+    if (res != MAP_SUCCESS) {
+        if (res == MAP_ALLOCATION_ERROR) {
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate frozen map storage.\n");
+        } else {
+            fprintf(stderr, "MAP_FAILURE: No perfect hash found; keys may share a hash value.\n");
+        }
+        free(frozen->entries);
+        free(frozen->pilots);
+        free(frozen);
+        return NULL;
+    }
+
+    // The entries now belong to the frozen map: destroy the map without freeing them
+    frozen->key_arena = map->key_arena;
+    map->key_arena.chunks = NULL;
+    map->key_free_func = NULL;
+    map->value_free_func = NULL;
+    map_destroy(map);
+    return frozen;
+}
+
+/**
+ * @brief Destroys the frozen map and frees all associated memory.
+ * @param map Pointer to the frozen map to destroy.
+ */
+void frozen_map_destroy(frozen_map_t *map) {
+    if (map == NULL) return;
+
+    for (size_t i = 0; i < map->size; ++i) {
+        if (map->key_free_func && map->entries[i].key) {
+            map->key_free_func(map->entries[i].key);
+        }
+        if (map->value_free_func && map->entries[i].value) {
+            map->value_free_func(map->entries[i].value);
+        }
+    }
+    _map_arena_release(&map->key_arena);
+    free(map->entries);
+    free(map->pilots);
+    free(map);
+}
+
+/**
+ * @brief Looks a key up with a single probe.
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the key.
+ * @param key_len Key length in bytes (MAP_KEY_BYTES only).
+ * @return The entry holding the key, or NULL if the key is not found.
+ */
+static const frozen_entry_t *_frozen_find(const frozen_map_t *map, const void *key, size_t key_len) {
+    if (map->size == 0) {
+        return NULL;
+    }
+
+    // Same hash as _map_hash_key in the original map
+    uint64_t hash;
+    if (map->key_mode == MAP_KEY_BYTES) {
+        hash = map->keyed_hash ? _map_siphash13(key, key_len, map->hash_seed) : hash_bytes(key, key_len);
+    } else {
+        hash = (uint64_t)map->hash_func(key);
+        if (map->mix_hash) {
+            hash = _map_mix64(hash);
+        }
+    }
+
+    frozen_derived_t derived = _frozen_derive(hash, map->seed, map->bucket_count, map->size);
+    const frozen_entry_t *entry = &map->entries[_frozen_slot(&derived, map->pilots[derived.bucket], map->size)];
+    if (entry->hash != hash) {
+        return NULL; // Keys that were never stored land on an arbitrary slot
+    }
+    if (map->key_mode == MAP_KEY_BYTES) {
+        return (entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0) ? entry : NULL;
+    }
+    return (map->compare_func(entry->key, key) == 0) ? entry : NULL;
+}
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *frozen_map_get(const frozen_map_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    size_t key_len = (map->key_mode == MAP_KEY_BYTES) ? strlen((const char *)key) : 0;
+    const frozen_entry_t *entry = _frozen_find(map, key, key_len);
+    return (entry != NULL) ? entry->value : NULL;
+}
+
+/**
+ * @brief Retrieves the value associated with a key of explicit length.
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the first key byte.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *frozen_map_get_n(const frozen_map_t *map, const void *key, size_t key_len) {
+    if (map == NULL || key == NULL || map->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    const frozen_entry_t *entry = _frozen_find(map, key, key_len);
+    return (entry != NULL) ? entry->value : NULL;
+}
+
+/**
+ * @brief Checks if a key exists in the frozen map.
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int frozen_map_contains(const frozen_map_t *map, const void *key) {
+    return frozen_map_get(map, key) != NULL;
+}
+
+/**
+ * @brief Returns the number of key-value pairs in the frozen map.
+ * @param map Pointer to the frozen map.
+ * @return The size of the frozen map.
+ */
+size_t frozen_map_size(const frozen_map_t *map) {
+    return (map != NULL) ? map->size : 0;
+}
+
+/**
+ * @brief Iterates over all key-value pairs in slot order.
+ * @param map Pointer to the frozen map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t frozen_map_iterate(const frozen_map_t *map, map_iter_func_t callback_func, void *user_data) {
+    if (map == NULL || callback_func == NULL) {
+        return MAP_FAILURE;
+    }
+
+    for (size_t i = 0; i < map->size; ++i) {
+        if (callback_func(map->entries[i].key, map->entries[i].value, user_data) != 0) {
+            return MAP_FAILURE; // Callback requested to stop iteration
+        }
+    }
+    return MAP_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#ifndef FROZEN_MAP_H
+#define FROZEN_MAP_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Immutable map built from a map_t with a minimal perfect hash.
+// map_freeze lays the n entries out in an array of exactly n slots and computes
+// a small displacement table (CHD: "compress, hash, displace") that sends every
+// stored key to its own slot. A lookup hashes the key, reads one displacement
+// and probes exactly one slot, comparing a single key. The only overhead beyond
+// the entries themselves is 8 bytes per 4 keys for the displacements.
+typedef struct frozen_map_t frozen_map_t;
+
+/**
+ * @brief Turns a map into an immutable frozen map.
+ * On success the map is consumed: its keys and values, and the responsibility
+ * for freeing them, move to the frozen map, and the map itself is destroyed.
+ * Freezing needs the stored keys to have pairwise distinct hashes; it fails
+ * otherwise (for instance with a hash_func that maps many keys to one value).
+ * @param map Pointer to the map to freeze.
+ * @return A pointer to the frozen map, or NULL on error (the map is then left untouched).
+ */
+frozen_map_t *map_freeze(map_t *map);
+
+/**
+ * @brief Destroys the frozen map, freeing keys and values with the original map's free functions.
+ * @param map Pointer to the frozen map to destroy.
+ */
+void frozen_map_destroy(frozen_map_t *map);
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *frozen_map_get(const frozen_map_t *map, const void *key);
+
+/**
+ * @brief Retrieves the value associated with a key of explicit length (MAP_KEY_BYTES maps).
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *frozen_map_get_n(const frozen_map_t *map, const void *key, size_t key_len);
+
+/**
+ * @brief Checks if a key exists in the frozen map.
+ * @param map Pointer to the frozen map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int frozen_map_contains(const frozen_map_t *map, const void *key);
+
+/**
+ * @brief Returns the number of key-value pairs in the frozen map.
+ * @param map Pointer to the frozen map.
+ * @return The size of the frozen map.
+ */
+size_t frozen_map_size(const frozen_map_t *map);
+
+/**
+ * @brief Iterates over all key-value pairs in slot order.
+ * @param map Pointer to the frozen map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t frozen_map_iterate(const frozen_map_t *map, map_iter_func_t callback_func, void *user_data);
+
+#endif // FROZEN_MAP_H
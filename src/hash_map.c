@@ -1,86 +1,437 @@
 #include "hash_map.h" 
+#include "hash_map_internal.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 
-// This is the full definition of the node, which is an internal detail.
-typedef struct map_node_t {
-    void *key;
-    void *value;
-    struct map_node_t *next;
-} map_node_t;
-
-// This is the full definition of the map, hidden from users of the header.
-struct map_t {
-    map_node_t **buckets;      // Array of pointers to linked list heads (buckets)
-    size_t capacity;           // Current number of buckets
-    size_t size;               // Current number of key-value pairs stored
-    hash_func_t hash_func;     // Function to hash keys
-    compare_func_t compare_func; // Function to compare keys
-    free_func_t key_free_func; // Optional: Function to free key memory
-    free_func_t value_free_func; // Optional: Function to free value memory
-};
-
 #define INITIAL_CAPACITY 16    // Default initial number of buckets
 #define LOAD_FACTOR_THRESHOLD 0.75 // Resize when size/capacity exceeds this
 #define RESIZE_FACTOR 2        // Factor by which capacity grows
+#define REHASH_STEP_BUCKETS 4  // Incremental resize: non-empty old buckets migrated per operation
+#define REHASH_STEP_MAX_VISITS 40 // Incremental resize: old buckets inspected per operation
+#define BATCH_WINDOW 16        // Keys hashed and prefetched ahead of resolution in batch lookups
+#define PARALLEL_SCAN_CHUNK 16384 // Buckets or slots a map_for_each_parallel worker claims at a time
+#define PARALLEL_SCAN_ALIGN 64 // Accumulator copies are padded to this many bytes
+#define AUTO_SHRINK_MIN_CAPACITY 64 // Auto-shrink leaves maps with at most this many buckets/slots alone
+#define AUTO_SHRINK_DIVISOR 8  // Auto-shrink once size drops below capacity / AUTO_SHRINK_DIVISOR
+
+#define PARALLEL_RESIZE_MIN_BUCKETS 65536 // Smaller maps always rehash on the calling thread
+#define PARALLEL_RESIZE_CHUNK 4096 // Old buckets a resize worker claims at a time
+#define NODE_SLAB_MIN 32       // Nodes in the first slab of a map
+#define NODE_SLAB_MAX 8192     // Slabs double in size up to this many nodes
+#define ARENA_CHUNK_MIN 4096   // Bytes in the first key arena chunk of a map
+#define ARENA_CHUNK_MAX (1 << 20) // Arena chunks double in size up to this many bytes
+#define FILTER_MIN_ENTRIES 64  // Smallest number of entries a filter is sized for
+#define FILTER_ALIGN 64        // Filter blocks start on a cache line boundary
+#define RESEED_CHAIN_LENGTH 16 // Keyed chained maps reseed once a chain grows past this many nodes
+
+/**
+ * @brief Allocates a new slab for the node pool.
+ * @param pool Pointer to the pool.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure.
+ */
+static map_result_t _map_node_pool_grow(map_node_pool_t *pool) {
+    size_t count = NODE_SLAB_MIN;
+    if (pool->slabs != NULL) {
+        count = pool->slabs->count * 2;
+        if (count > NODE_SLAB_MAX) {
+            count = NODE_SLAB_MAX;
+        }
+    }
+
+    map_node_slab_t *slab = (map_node_slab_t *)malloc(sizeof(map_node_slab_t) + count * sizeof(map_node_t));
+    if (slab == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map node slab.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+    slab->count = count;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_used = 0;
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Releases every slab of the node pool at once.
+ * Nodes still in use become invalid; their keys and values are not freed.
+ * @param pool Pointer to the pool.
+ */
+static void _map_node_pool_release(map_node_pool_t *pool) {
+    map_node_slab_t *slab = pool->slabs;
+    while (slab != NULL) {
+        map_node_slab_t *next_slab = slab->next;
+        free(slab);
+        slab = next_slab;
+    }
+    pool->slabs = NULL;
+    pool->slab_used = 0;
+    pool->free_nodes = NULL;
+}
+
+/**
+ * @brief Copies a key into the arena.
+ * Keys larger than a quarter of the next chunk get a chunk of their own, which
+ * goes behind the current one so the space left there is not wasted.
+ * @param arena Pointer to the arena.
+ * @param key Pointer to the key bytes.
+ * @param len Number of bytes to copy.
+ * @param terminate Non-zero to append a NUL byte after the copy.
+ * @return A pointer to the copy, or NULL on allocation failure.
+ */
+static void *_map_arena_copy(map_key_arena_t *arena, const void *key, size_t len, int terminate) {
+    size_t need = len + (terminate ? 1 : 0);
+    map_arena_chunk_t *chunk = arena->chunks;
+    if (chunk == NULL || chunk->size - arena->used < need) {
+        size_t size = ARENA_CHUNK_MIN;
+        if (chunk != NULL) {
+            size = chunk->size * 2;
+            if (size > ARENA_CHUNK_MAX) {
+                size = ARENA_CHUNK_MAX;
+            }
+        }
+        int oversized = (need > size / 4);
+        if (oversized) {
+            size = need;
+        }
+
+        map_arena_chunk_t *new_chunk = (map_arena_chunk_t *)malloc(sizeof(map_arena_chunk_t) + size);
+        if (new_chunk == NULL) {
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate key arena chunk.\n");
+            return NULL;
+        }
+        new_chunk->size = size;
+        if (oversized && chunk != NULL) {
+            new_chunk->next = chunk->next;
+            chunk->next = new_chunk;
+            memcpy(new_chunk->data, key, len);
+            if (terminate) new_chunk->data[len] = '\0';
+            return new_chunk->data;
+        }
+        new_chunk->next = chunk;
+        arena->chunks = new_chunk;
+        arena->used = 0;
+        chunk = new_chunk;
+    }
+
+    char *copy = chunk->data + arena->used;
+    memcpy(copy, key, len);
+    if (terminate) copy[len] = '\0';
+    arena->used += need;
+    return copy;
+}
+
+/**
+ * @brief Releases every chunk of a key arena at once.
+ * @param arena Pointer to the arena.
+ */
+void _map_arena_release(map_key_arena_t *arena) {
+    map_arena_chunk_t *chunk = arena->chunks;
+    while (chunk != NULL) {
+        map_arena_chunk_t *next_chunk = chunk->next;
+        free(chunk);
+        chunk = next_chunk;
+    }
+    arena->chunks = NULL;
+    arena->used = 0;
+}
+
+/**
+ * @brief Replaces the map's filter with one sized for `entries` and refills it.
+ * The filter only ever gains bits on insert, so deleted keys keep answering
+ * "maybe" until the next rebuild; rebuilding drops them.
+ * @param map Pointer to a map created with bloom_bits_per_key > 0.
+ * @param entries Number of entries to size the filter for. Raised to the map's size if smaller.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure (the old filter is kept).
+ */
+static map_result_t _map_filter_rebuild(map_t *map, size_t entries) {
+    if (entries < map->size) entries = map->size;
+    if (entries < FILTER_MIN_ENTRIES) entries = FILTER_MIN_ENTRIES;
+
+    size_t block_bits = MAP_FILTER_BLOCK_WORDS * 64;
+    size_t blocks = (entries * map->filter_bits_per_key + block_bits - 1) / block_bits;
+    if (blocks > UINT32_MAX) blocks = UINT32_MAX; // Block selection uses 32 hash bits
+
+    size_t bytes = blocks * MAP_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    void *alloc = calloc(1, bytes + FILTER_ALIGN);
+    if (alloc == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate filter.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    free(map->filter_alloc);
+    map->filter_alloc = alloc;
+    map->filter = (uint64_t *)(((uintptr_t)alloc + FILTER_ALIGN - 1) & ~(uintptr_t)(FILTER_ALIGN - 1));
+    map->filter_blocks = blocks;
+    map->filter_capacity = entries;
+
+    map_iter_t it;
+    map->ops->iter_begin(map, &it);
+    while (map->ops->iter_next(map, &it)) {
+        _map_filter_add(map, it.hash);
+    }
+    return MAP_SUCCESS;
+}
 
 /**
- * @brief Creates a new map node.
+ * @brief Creates a new map node from the map's node pool and appends it to the entry list.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key; its hash and length are cached in the node.
  * @param key Pointer to the key.
  * @param value Pointer to the value.
  * @return A pointer to the newly created node, or NULL on allocation error.
  */
-static map_node_t *_map_node_create(void *key, void *value) {
-    map_node_t *node = (map_node_t *)malloc(sizeof(map_node_t));
-    if (node == NULL) {
-        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map node.\n");
-        return NULL;
+static map_node_t *_map_node_create(map_t *map, const map_lookup_t *lookup, void *key, void *value) {
+    map_node_pool_t *pool = &map->node_pool;
+    map_node_t *node = pool->free_nodes;
+
+    if (node != NULL) {
+        pool->free_nodes = node->next;
+    } else {
+        if (pool->slabs == NULL || pool->slab_used == pool->slabs->count) {
+            if (_map_node_pool_grow(pool) != MAP_SUCCESS) {
+                return NULL;
+            }
+        }
+        node = &pool->slabs->nodes[pool->slab_used++];
     }
+
     node->key = key;
     node->value = value;
     node->next = NULL;
+    node->hash = lookup->hash;
+    node->key_len = lookup->key_len;
+
+    // Append to the entry list
+    node->list_prev = map->list_tail;
+    node->list_next = NULL;
+    if (map->list_tail != NULL) {
+        map->list_tail->list_next = node;
+    } else {
+        map->list_head = node;
+    }
+    map->list_tail = node;
     return node;
 }
 
 /**
  * @brief Destroys a map node, optionally freeing key and value memory.
+ * The node is unlinked from the entry list and goes back to the map's node pool.
+ * @param map Pointer to the map.
  * @param node Pointer to the node to destroy.
- * @param key_free_func Optional function to free key memory.
- * @param value_free_func Optional function to free value memory.
  */
-static void _map_node_destroy(map_node_t *node, free_func_t key_free_func, free_func_t value_free_func) {
+static void _map_node_destroy(map_t *map, map_node_t *node) {
     if (node == NULL) return;
 
-    if (key_free_func && node->key) {
-        key_free_func(node->key);
+    // Unlink from the entry list
+    if (node->list_prev != NULL) {
+        node->list_prev->list_next = node->list_next;
+    } else {
+        map->list_head = node->list_next;
     }
-    if (value_free_func && node->value) {
-        value_free_func(node->value);
+    if (node->list_next != NULL) {
+        node->list_next->list_prev = node->list_prev;
+    } else {
+        map->list_tail = node->list_prev;
     }
-    free(node);
+
+    _map_free_pair(map, node->key, node->value);
+    node->next = map->node_pool.free_nodes;
+    map->node_pool.free_nodes = node;
 }
 
 /**
- * @brief Calculates the bucket index for a given key.
+ * @brief Moves a node to the back of the entry list, making it the newest entry.
  * @param map Pointer to the map.
- * @param key Pointer to the key.
+ * @param value Address of the node's value field.
+ */
+void _map_chained_move_to_back(map_t *map, void **value) {
+    map_node_t *node = (map_node_t *)((char *)value - offsetof(map_node_t, value));
+    if (node == map->list_tail) return;
+
+    // Unlink; the node is not the tail, so it has a successor
+    if (node->list_prev != NULL) {
+        node->list_prev->list_next = node->list_next;
+    } else {
+        map->list_head = node->list_next;
+    }
+    node->list_next->list_prev = node->list_prev;
+
+    node->list_prev = map->list_tail;
+    node->list_next = NULL;
+    map->list_tail->list_next = node;
+    map->list_tail = node;
+}
+
+/**
+ * @brief Calculates the index of a hash in a bucket array of the given size.
+ * Power-of-two maps mask the (mixed) hash instead of paying for a division.
+ * @param map Pointer to the map.
+ * @param hash Hash of the key, as computed by _map_hash_key.
+ * @param capacity Number of buckets in the array.
+ * @return The calculated bucket index.
+ */
+static inline size_t _map_bucket_index_for(const map_t *map, uint64_t hash, size_t capacity) {
+    if (map->pow2_capacity) {
+        return (size_t)hash & (capacity - 1);
+    }
+    return (size_t)(hash % capacity);
+}
+
+/**
+ * @brief Calculates the bucket index for a given hash.
+ * @param map Pointer to the map.
+ * @param hash Hash of the key, as computed by _map_hash_key.
  * @return The calculated bucket index.
  */
-static size_t _map_get_bucket_index(const map_t *map, const void *key) {
-    // Ensure the hash function is provided
-    if (map->hash_func == NULL) {
-        fprintf(stderr, "MAP_FAILURE: Hash function not set.\n");
-        return 0; // Or handle as an error
+static size_t _map_get_bucket_index(const map_t *map, uint64_t hash) {
+    return _map_bucket_index_for(map, hash, map->capacity);
+}
+
+/**
+ * @brief Moves every node of one old bucket into the current bucket array.
+ * @param map Pointer to the map.
+ * @param old_bucket Head of the old chain; the caller clears the old slot.
+ */
+static void _map_rehash_chain(map_t *map, map_node_t *old_bucket) {
+    map_node_t *current = old_bucket;
+    while (current != NULL) {
+        map_node_t *next_node = current->next; // Save next node before modifying current
+
+        // Calculate new index for the current node from its cached hash
+        size_t new_index = _map_get_bucket_index(map, current->hash);
+
+        // Add the current node to the head of the linked list in the new bucket
+        current->next = map->buckets[new_index];
+        map->buckets[new_index] = current;
+
+        current = next_node;
+    }
+}
+
+// Shared state of a parallel rehash.
+typedef struct {
+    map_t *map;
+    map_node_t **old_buckets;
+} map_rehash_job_t;
+
+/**
+ * @brief Migrates old buckets [begin, end) of a parallel rehash.
+ * New capacity is a multiple of the old one, so a node in old bucket i only moves
+ * to a new bucket congruent to i; ranges never write the same new bucket.
+ */
+static void _map_rehash_range(void *context, size_t worker, size_t begin, size_t end) {
+    map_rehash_job_t *job = (map_rehash_job_t *)context;
+    (void)worker;
+    for (size_t i = begin; i < end; ++i) {
+        _map_rehash_chain(job->map, job->old_buckets[i]);
+    }
+}
+
+/**
+ * @brief Performs a bounded amount of work on a pending incremental resize.
+ * Migrates up to REHASH_STEP_BUCKETS non-empty old buckets, inspecting at most
+ * REHASH_STEP_MAX_VISITS old buckets, and frees the old array once it is drained.
+ * @param map Pointer to the map.
+ */
+static void _map_rehash_step(map_t *map) {
+    if (map->old_buckets == NULL) return;
+
+    size_t migrated = 0;
+    size_t visited = 0;
+    while (map->rehash_index < map->old_capacity &&
+           migrated < REHASH_STEP_BUCKETS && visited < REHASH_STEP_MAX_VISITS) {
+        map_node_t *chain = map->old_buckets[map->rehash_index];
+        if (chain != NULL) {
+            map->old_buckets[map->rehash_index] = NULL;
+            _map_rehash_chain(map, chain);
+            migrated++;
+        }
+        map->rehash_index++;
+        visited++;
+    }
+
+    if (map->rehash_index == map->old_capacity) {
+        free(map->old_buckets);
+        map->old_buckets = NULL;
+        map->old_capacity = 0;
+        map->rehash_index = 0;
+    }
+}
+
+/**
+ * @brief Completes a pending incremental resize in one go.
+ * @param map Pointer to the map.
+ */
+static void _map_rehash_finish(map_t *map) {
+    if (map->old_buckets == NULL) return;
+
+    for (size_t i = map->rehash_index; i < map->old_capacity; ++i) {
+        _map_rehash_chain(map, map->old_buckets[i]);
+    }
+    free(map->old_buckets);
+    map->old_buckets = NULL;
+    map->old_capacity = 0;
+    map->rehash_index = 0;
+}
+
+/**
+ * @brief Draws a fresh secret key for the map's keyed hash.
+ * Reads the operating system's random source and falls back to mixing the
+ * clock, addresses and a counter where there is none.
+ * @param seed Receives the two key words.
+ */
+static void _map_random_seed(uint64_t seed[2]) {
+    static uint64_t counter = 0;
+    size_t got = 0;
+#ifndef _WIN32
+    FILE *urandom = fopen("/dev/urandom", "rb");
+    if (urandom != NULL) {
+        got = fread(seed, sizeof(uint64_t), 2, urandom);
+        fclose(urandom);
+    }
+#endif
+    if (got != 2) {
+        uint64_t entropy = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^ (uint64_t)(uintptr_t)seed;
+        counter += 0x9e3779b97f4a7c15ULL;
+        seed[0] = _map_mix64(entropy ^ counter);
+        seed[1] = _map_mix64(seed[0] ^ (uint64_t)(uintptr_t)&counter);
+    }
+}
+
+/**
+ * @brief Switches a keyed chained map to a new seed and rehashes every node in place.
+ * Nodes keep their addresses; only their cached hashes and bucket links change.
+ * @param map Pointer to the map.
+ */
+static void _map_chained_reseed(map_t *map) {
+    _map_rehash_finish(map); // Old buckets were filled under the old seed
+    _map_random_seed(map->hash_seed);
+
+    memset(map->buckets, 0, map->capacity * sizeof(map_node_t *));
+    for (map_node_t *node = map->list_head; node != NULL; node = node->list_next) {
+        node->hash = _map_hash_key(map, node->key, node->key_len);
+        size_t index = _map_get_bucket_index(map, node->hash);
+        node->next = map->buckets[index];
+        map->buckets[index] = node;
+    }
+
+    if (map->filter != NULL) {
+        // A failed rebuild would leave a filter of stale hashes, so drop it instead
+        if (_map_filter_rebuild(map, map->filter_capacity) != MAP_SUCCESS) {
+            free(map->filter_alloc);
+            map->filter = NULL;
+            map->filter_alloc = NULL;
+        }
     }
-    return map->hash_func(key) % map->capacity;
 }
 
 /**
  * @brief Resizes the hash map to a new capacity.
  * This involves creating a new, larger array of buckets and rehashing all existing elements.
+ * With incremental resizing the old array is kept and drained by later operations instead.
  * @param map Pointer to the map to resize.
  * @param new_capacity The desired new capacity for the map.
  * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure.
@@ -97,31 +448,34 @@ static map_result_t _map_resize(map_t *map, size_t new_capacity) {
         return MAP_ALLOCATION_ERROR;
     }
 
+    // At most one resize is in flight at a time
+    _map_rehash_finish(map);
+
     // Store old capacity and buckets
     size_t old_capacity = map->capacity;
     map_node_t **old_buckets = map->buckets;
 
-    // Temporarily update map's capacity and buckets to use the new ones
+    // Update map's capacity and buckets to use the new ones
     // This is crucial for _map_get_bucket_index to work correctly during rehashing
     map->capacity = new_capacity;
     map->buckets = new_buckets;
-    map->size = 0; // Reset size, it will be recalculated during reinsertion
 
-    // Rehash all existing nodes into the new buckets
-    for (size_t i = 0; i < old_capacity; ++i) {
-        map_node_t *current = old_buckets[i];
-        while (current != NULL) {
-            map_node_t *next_node = current->next; // Save next node before modifying current
-
-            // Calculate new index for the current node
-            size_t new_index = _map_get_bucket_index(map, current->key);
-
-            // Add the current node to the head of the linked list in the new bucket
-            current->next = map->buckets[new_index];
-            map->buckets[new_index] = current;
-            map->size++; // Increment size for each reinserted element
+    if (map->incremental_resize) {
+        // Leave the nodes where they are; _map_rehash_step moves them over time
+        map->old_buckets = old_buckets;
+        map->old_capacity = old_capacity;
+        map->rehash_index = 0;
+        return MAP_SUCCESS;
+    }
 
-            current = next_node;
+    // Rehash all existing nodes into the new buckets
+    if (map->resize_threads > 1 && old_capacity >= PARALLEL_RESIZE_MIN_BUCKETS &&
+        new_capacity % old_capacity == 0) {
+        map_rehash_job_t job = { map, old_buckets };
+        _map_parallel_for(map->resize_threads, old_capacity, PARALLEL_RESIZE_CHUNK, _map_rehash_range, &job);
+    } else {
+        for (size_t i = 0; i < old_capacity; ++i) {
+            _map_rehash_chain(map, old_buckets[i]);
         }
     }
 
@@ -132,241 +486,1243 @@ static map_result_t _map_resize(map_t *map, size_t new_capacity) {
 }
 
 /**
- * @brief Creates and initializes a new hash map.
- * @param initial_capacity The initial number of buckets. If 0, uses INITIAL_CAPACITY.
- * @param hash_func Function to hash keys. MUST NOT be NULL.
- * @param compare_func Function to compare keys. MUST NOT be NULL.
- * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
- * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
- * @return A pointer to the newly created map, or NULL on error.
+ * @brief Finds the link (bucket head or next pointer) that points at a key's node.
+ * During an incremental resize both the current and the old bucket arrays are searched.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @return Address of the pointer to the node, or NULL if the key is not found.
  */
-map_t *map_create(
-    size_t initial_capacity, 
-    hash_func_t hash_func, 
-    compare_func_t compare_func,
-    free_func_t key_free_func, 
-    free_func_t value_free_func) {
-    if (hash_func == NULL || compare_func == NULL) {
-        fprintf(stderr, "MAP_FAILURE: Hash function and compare function cannot be NULL.\n");
-        return NULL;
+static map_node_t **_map_chained_find_link(const map_t *map, const map_lookup_t *lookup) {
+    map_node_t **link = &map->buckets[_map_get_bucket_index(map, lookup->hash)];
+    for (; *link != NULL; link = &(*link)->next) {
+        if (_map_key_equals(map, (*link)->hash, (*link)->key, (*link)->key_len, lookup)) {
+            return link;
+        }
     }
 
-    map_t *map = (map_t *)malloc(sizeof(map_t));
-    if (map == NULL) {
-        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map structure.\n");
-        return NULL;
+    if (map->old_buckets != NULL) {
+        // Already migrated buckets are empty, so no need to compare against rehash_index
+        link = &map->old_buckets[_map_bucket_index_for(map, lookup->hash, map->old_capacity)];
+        for (; *link != NULL; link = &(*link)->next) {
+            if (_map_key_equals(map, (*link)->hash, (*link)->key, (*link)->key_len, lookup)) {
+                return link;
+            }
+        }
     }
 
-    map->capacity = (initial_capacity > 0) ? initial_capacity : INITIAL_CAPACITY;
-    map->size = 0;
-    map->hash_func = hash_func;
-    map->compare_func = compare_func;
-    map->key_free_func = key_free_func;
-    map->value_free_func = value_free_func;
+    return NULL;
+}
 
+/**
+ * @brief Allocates the bucket array of a chained map.
+ * @param map Pointer to the map.
+ * @param capacity The initial number of buckets.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure.
+ */
+static map_result_t _map_chained_init(map_t *map, size_t capacity) {
+    map->capacity = map->pow2_capacity ? _map_round_pow2(capacity, 1) : capacity;
     map->buckets = (map_node_t **)calloc(map->capacity, sizeof(map_node_t *));
     if (map->buckets == NULL) {
         fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map buckets.\n");
-        free(map);
-        return NULL;
+        return MAP_ALLOCATION_ERROR;
     }
-
-    return map;
+    return MAP_SUCCESS;
 }
 
 /**
- * @brief Destroys the hash map and frees all associated memory.
- * Iterates through all buckets and frees each node and its associated key/value data
- * if free functions are provided.
- * @param map Pointer to the map to destroy.
+ * @brief Frees every node of a chained map and its bucket array.
+ * Runs in O(slabs) when the map has no free functions.
+ * @param map Pointer to the map.
  */
-void map_destroy(map_t *map) {
-    if (map == NULL) return;
-
-    for (size_t i = 0; i < map->capacity; ++i) {
-        map_node_t *current = map->buckets[i];
-        while (current != NULL) {
-            map_node_t *next_node = current->next;
-            _map_node_destroy(current, map->key_free_func, map->value_free_func);
-            current = next_node;
+static void _map_chained_destroy(map_t *map) {
+    // Nodes are released with their slabs; only walk the chains when there
+    // are keys or values to free.
+    if (map->key_free_func != NULL || map->value_free_func != NULL) {
+        for (map_node_t *current = map->list_head; current != NULL; current = current->list_next) {
+            _map_free_pair(map, current->key, current->value);
         }
     }
+    _map_node_pool_release(&map->node_pool);
+    free(map->old_buckets);
     free(map->buckets);
-    free(map);
 }
 
 /**
- * @brief Inserts a key-value pair into the map. If the key already exists, its value is updated.
- * Handles automatic resizing if the load factor threshold is exceeded.
+ * @brief Finds the node of a key, or creates one holding `key` and a NULL value.
+ * Grows the bucket array when the load factor threshold would be exceeded.
  * @param map Pointer to the map.
- * @param key Pointer to the key.
- * @param value Pointer to the value.
- * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key to store if it is absent.
+ * @param inserted Receives 1 if a node was created, 0 if the key already existed.
+ * @return The key's node, or NULL on allocation failure.
  */
-map_result_t map_insert(map_t *map, void *key, void *value) {
-    if (map == NULL || key == NULL) {
-        return MAP_FAILURE;
+static map_node_t *_map_chained_claim(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    _map_rehash_step(map);
+
+    map_node_t **link = _map_chained_find_link(map, lookup);
+    if (link != NULL) {
+        *inserted = 0;
+        return *link;
     }
 
     // Check if resize is needed
     if ((double)(map->size + 1) / map->capacity > LOAD_FACTOR_THRESHOLD) {
-        map_result_t res = _map_resize(map, map->capacity * RESIZE_FACTOR);
-        if (res != MAP_SUCCESS) {
-            return res; // Failed to resize
-        }
-    }
-
-    size_t index = _map_get_bucket_index(map, key);
-    map_node_t *current = map->buckets[index];
-
-    // Check if key already exists (update value)
-    while (current != NULL) {
-        if (map->compare_func(current->key, key) == 0) {
-            // Key found, free old value if free_func is set, then update
-            if (map->value_free_func && current->value) {
-                map->value_free_func(current->value);
-            }
-            // Free old key if it was dynamically allocated and different from new key
-            // This handles cases where a new key with same content is provided
-            if (map->key_free_func && current->key != key) {
-                map->key_free_func(current->key);
-            }
-            current->key = key; // Update key pointer (might be the same)
-            current->value = value;
-            return MAP_SUCCESS;
+        if (_map_resize(map, map->capacity * RESIZE_FACTOR) != MAP_SUCCESS) {
+            return NULL; // Failed to resize
         }
-        current = current->next;
     }
 
     // Key not found, insert new node at the head of the linked list
-    map_node_t *new_node = _map_node_create(key, value);
+    map_node_t *new_node = _map_node_create(map, lookup, key, NULL);
     if (new_node == NULL) {
-        return MAP_ALLOCATION_ERROR;
+        return NULL;
     }
 
+    size_t index = _map_get_bucket_index(map, lookup->hash);
     new_node->next = map->buckets[index];
     map->buckets[index] = new_node;
     map->size++;
 
-    return MAP_SUCCESS;
+    if (map->reseed_chain_length > 0) {
+        size_t length = 0;
+        for (map_node_t *node = new_node; node != NULL && length <= map->reseed_chain_length; node = node->next) {
+            length++;
+        }
+        if (length > map->reseed_chain_length) {
+            // Random keys essentially never chain this long; the seed has leaked or been guessed
+            _map_chained_reseed(map);
+        }
+    }
+
+    *inserted = 1;
+    return new_node;
 }
 
 /**
- * @brief Retrieves the value associated with a given key.
+ * @brief Inserts or updates a key in a chained map, growing the bucket array when needed.
  * @param map Pointer to the map.
- * @param key Pointer to the key to search for.
- * @return A pointer to the value if found, or NULL if the key is not found.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key to store.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure.
  */
-void *map_get(const map_t *map, const void *key) {
-    if (map == NULL || key == NULL) {
-        return NULL;
+static map_result_t _map_chained_insert(map_t *map, const map_lookup_t *lookup, void *key, void *value) {
+    int inserted;
+    map_node_t *node = _map_chained_claim(map, lookup, key, &inserted);
+    if (node == NULL) {
+        return MAP_ALLOCATION_ERROR;
     }
 
-    size_t index = _map_get_bucket_index(map, key);
-    map_node_t *current = map->buckets[index];
-
-    while (current != NULL) {
-        if (map->compare_func(current->key, key) == 0) {
-            return current->value; // Key found
-        }
-        current = current->next;
+    if (inserted) {
+        node->value = value;
+    } else {
+        // Key found: free the old value (and old key if replaced), then update
+        _map_replace_pair(map, &node->key, &node->value, key, value);
     }
+    return MAP_SUCCESS;
+}
 
-    return NULL; // Key not found
+/**
+ * @brief Finds a key in a chained map, or inserts it with a NULL value.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key to store if it is absent.
+ * @param inserted Receives 1 if the key was inserted, 0 if it already existed.
+ * @return The address of the value, or NULL on allocation failure.
+ */
+static void **_map_chained_entry(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    map_node_t *node = _map_chained_claim(map, lookup, key, inserted);
+    return (node != NULL) ? &node->value : NULL;
 }
 
 /**
- * @brief Checks if a key exists in the map.
+ * @brief Looks up a key in a chained map.
  * @param map Pointer to the map.
- * @param key Pointer to the key to check.
- * @return 1 if the key exists, 0 otherwise.
+ * @param lookup The hashed key.
+ * @return The address of the stored value, or NULL if the key is not found.
  */
-int map_contains(const map_t *map, const void *key) {
-    return map_get(map, key) != NULL;
+static void **_map_chained_find(const map_t *map, const map_lookup_t *lookup) {
+    // Lookups share the migration work of an incremental resize. The map is
+    // never a const object, only a const view of one, so this cast is safe.
+    _map_rehash_step((map_t *)map);
+
+    map_node_t **link = _map_chained_find_link(map, lookup);
+    return (link != NULL) ? &(*link)->value : NULL;
 }
 
 /**
- * @brief Deletes a key-value pair from the map.
- * Optionally frees the key and value memory if free functions are set.
+ * @brief Unlinks and destroys the node holding a key in a chained map.
  * @param map Pointer to the map.
- * @param key Pointer to the key to delete.
- * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ * @param lookup The hashed key.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found.
  */
-map_result_t map_delete(map_t *map, const void *key) {
-    if (map == NULL || key == NULL) {
-        return MAP_FAILURE;
+static map_result_t _map_chained_remove(map_t *map, const map_lookup_t *lookup) {
+    _map_rehash_step(map);
+
+    map_node_t **link = _map_chained_find_link(map, lookup);
+    if (link == NULL) {
+        return MAP_KEY_NOT_FOUND; // Key not found
     }
 
-    size_t index = _map_get_bucket_index(map, key);
-    map_node_t *current = map->buckets[index];
-    map_node_t *prev = NULL;
+    // Key found, remove node from list
+    map_node_t *current = *link;
+    *link = current->next;
+    _map_node_destroy(map, current);
+    map->size--;
+    return MAP_SUCCESS;
+}
 
-    while (current != NULL) {
-        if (map->compare_func(current->key, key) == 0) {
-            // Key found, remove node from list
-            if (prev == NULL) { // Node is the head of the list
-                map->buckets[index] = current->next;
-            } else {
-                prev->next = current->next;
-            }
-            _map_node_destroy(current, map->key_free_func, map->value_free_func);
-            map->size--;
-            return MAP_SUCCESS;
+/**
+ * @brief Walks the entry list of a chained map, in insertion order.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it.
+ */
+static map_result_t _map_chained_iterate(const map_t *map, map_iter_func_t callback_func, void *user_data) {
+    for (map_node_t *current = map->list_head; current != NULL; current = current->list_next) {
+        if (callback_func(current->key, current->value, user_data) != 0) {
+            return MAP_FAILURE; // Callback requested to stop iteration
         }
-        prev = current;
-        current = current->next;
     }
-
-    return MAP_KEY_NOT_FOUND; // Key not found
+    return MAP_SUCCESS;
 }
 
 /**
- * @brief Returns the number of key-value pairs in the map.
+ * @brief Prefetches the bucket heads a lookup in a chained map starts from.
  * @param map Pointer to the map.
- * @return The current size of the map.
+ * @param lookup The hashed key.
  */
-size_t map_size(const map_t *map) {
-    return (map != NULL) ? map->size : 0;
+static void _map_chained_prefetch(const map_t *map, const map_lookup_t *lookup) {
+    _map_prefetch(&map->buckets[_map_get_bucket_index(map, lookup->hash)]);
+    if (map->old_buckets != NULL) {
+        _map_prefetch(&map->old_buckets[_map_bucket_index_for(map, lookup->hash, map->old_capacity)]);
+    }
 }
 
 /**
- * @brief Iterates over all key-value pairs in the map, calling a callback function for each.
+ * @brief Resizes a chained map to the bucket count that holds `entries` below the load threshold.
  * @param map Pointer to the map.
- * @param callback_func The function to call for each key-value pair.
- * Iteration stops if this function returns a non-zero value.
- * @param user_data An opaque pointer to user-defined data passed to the callback.
- * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ * @param entries Number of entries to make room for; never less than the current size.
+ * @param shrink Non-zero to allow a smaller bucket array.
+ * @return MAP_SUCCESS on success (including when nothing had to change), MAP_ALLOCATION_ERROR on failure.
  */
-map_result_t map_iterate(const map_t *map, map_iter_func_t callback_func, void *user_data) {
-    if (map == NULL || callback_func == NULL) {
-        return MAP_FAILURE;
+static map_result_t _map_chained_reserve(map_t *map, size_t entries, int shrink) {
+    if (entries < map->size) {
+        entries = map->size;
     }
 
-    for (size_t i = 0; i < map->capacity; ++i) {
-        map_node_t *current = map->buckets[i];
-        while (current != NULL) {
-            if (callback_func(current->key, current->value, user_data) != 0) {
-                return MAP_FAILURE; // Callback requested to stop iteration
-            }
-            current = current->next;
-        }
+    size_t capacity = (size_t)((double)entries / LOAD_FACTOR_THRESHOLD) + 1;
+    if (map->pow2_capacity) {
+        capacity = _map_round_pow2(capacity, 1);
+    }
+
+    if (capacity > map->capacity || (shrink && capacity < map->capacity)) {
+        return _map_resize(map, capacity);
     }
     return MAP_SUCCESS;
 }
 
+static void _map_chained_iter_begin(const map_t *map, map_iter_t *it) {
+    it->node = map->list_head;
+}
+
+static int _map_chained_iter_next(const map_t *map, map_iter_t *it) {
+    (void)map;
+    map_node_t *node = (map_node_t *)it->node;
+    if (node == NULL) {
+        return 0;
+    }
+    // Remember the successor now so the current node may be removed
+    it->node = node->list_next;
+    it->key = node->key;
+    it->key_len = node->key_len;
+    it->value = node->value;
+    it->hash = node->hash;
+    return 1;
+}
+
+static void _map_chained_scan_range(const map_t *map, size_t begin, size_t end,
+                                    map_accum_func_t callback_func, void *accumulator) {
+    for (size_t i = begin; i < end; ++i) {
+        map_node_t *current = (i < map->capacity) ? map->buckets[i] : map->old_buckets[i - map->capacity];
+        for (; current != NULL; current = current->next) {
+            callback_func(current->key, current->value, accumulator);
+        }
+    }
+}
+
+const map_engine_ops_t map_chained_engine = {
+    _map_chained_init,
+    _map_chained_destroy,
+    _map_chained_insert,
+    _map_chained_entry,
+    _map_chained_find,
+    _map_chained_remove,
+    _map_chained_iterate,
+    _map_chained_prefetch,
+    _map_chained_reserve,
+    _map_chained_iter_begin,
+    _map_chained_iter_next,
+    _map_chained_scan_range,
+};
+
+/**
+ * @brief Creates and initializes a new hash map.
+ * @param initial_capacity The initial number of buckets. If 0, uses INITIAL_CAPACITY.
+ * @param hash_func Function to hash keys. MUST NOT be NULL.
+ * @param compare_func Function to compare keys. MUST NOT be NULL.
+ * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+map_t *map_create(
+    size_t initial_capacity, 
+    hash_func_t hash_func, 
+    compare_func_t compare_func,
+    free_func_t key_free_func, 
+    free_func_t value_free_func) {
+    return map_create_with_options(initial_capacity, hash_func, compare_func, key_free_func, value_free_func, NULL);
+}
+
 /**
- * @brief Simple hash function for C-style strings (djb2 algorithm).
+ * @brief Creates and initializes a new hash map with explicit options.
+ * @param initial_capacity The initial number of buckets or slots. If 0, uses INITIAL_CAPACITY.
+ * @param hash_func Function to hash keys. MUST NOT be NULL.
+ * @param compare_func Function to compare keys. MUST NOT be NULL.
+ * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
+ * @param options Optional: Creation options. NULL selects the defaults.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+map_t *map_create_with_options(
+    size_t initial_capacity,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options) {
+    map_options_t defaults = {0};
+    if (options == NULL) {
+        options = &defaults;
+    }
+
+    if (options->key_mode != MAP_KEY_BYTES && (hash_func == NULL || compare_func == NULL)) {
+        fprintf(stderr, "MAP_FAILURE: Hash function and compare function cannot be NULL.\n");
+        return NULL;
+    }
+
+    map_t *map = (map_t *)calloc(1, sizeof(map_t));
+    if (map == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map structure.\n");
+        return NULL;
+    }
+
+    switch (options->engine) {
+    case MAP_ENGINE_CHAINED:
+        map->ops = &map_chained_engine;
+        break;
+    case MAP_ENGINE_SWISS:
+        map->ops = &map_swiss_engine;
+        map->mix_hash = 1; // Tag and index bits are taken from opposite ends of the hash
+        map->pow2_capacity = 1;
+        break;
+    case MAP_ENGINE_ROBIN_HOOD:
+        map->ops = &map_robin_engine;
+        map->mix_hash = 1; // Indexes with a mask, so low bits must be well distributed
+        map->pow2_capacity = 1;
+        break;
+    default:
+        fprintf(stderr, "MAP_FAILURE: Unknown storage engine.\n");
+        free(map);
+        return NULL;
+    }
+
+    if (options->incremental_resize && options->engine != MAP_ENGINE_CHAINED) {
+        fprintf(stderr, "MAP_FAILURE: Incremental resize requires the chained engine.\n");
+        free(map);
+        return NULL;
+    }
+    if (options->copy_keys && key_free_func != NULL) {
+        fprintf(stderr, "MAP_FAILURE: Maps that copy their keys cannot take a key free function.\n");
+        free(map);
+        return NULL;
+    }
+    if (options->copy_keys && options->key_mode != MAP_KEY_BYTES) {
+        fprintf(stderr, "MAP_FAILURE: Copying keys requires MAP_KEY_BYTES keys, whose length is known.\n");
+        free(map);
+        return NULL;
+    }
+    map->copy_keys = options->copy_keys;
+    if (options->keyed_hash) {
+        if (options->key_mode != MAP_KEY_BYTES) {
+            fprintf(stderr, "MAP_FAILURE: Keyed hashing requires MAP_KEY_BYTES keys.\n");
+            free(map);
+            return NULL;
+        }
+        map->keyed_hash = 1;
+        _map_random_seed(map->hash_seed);
+        if (options->engine == MAP_ENGINE_CHAINED) {
+            map->reseed_chain_length = RESEED_CHAIN_LENGTH;
+        }
+    }
+    map->incremental_resize = options->incremental_resize;
+    map->auto_shrink = options->auto_shrink;
+    map->resize_threads = options->resize_threads;
+    map->filter_bits_per_key = options->bloom_bits_per_key;
+    if (options->pow2_capacity) {
+        // Masking only looks at the low bits, so every hash gets mixed first
+        map->pow2_capacity = 1;
+        map->mix_hash = 1;
+    }
+
+    map->size = 0;
+    map->hash_func = hash_func;
+    map->compare_func = compare_func;
+    map->key_mode = options->key_mode;
+    map->key_free_func = key_free_func;
+    map->value_free_func = value_free_func;
+
+    if (map->ops->init(map, (initial_capacity > 0) ? initial_capacity : INITIAL_CAPACITY) != MAP_SUCCESS) {
+        free(map);
+        return NULL;
+    }
+
+    if (map->filter_bits_per_key > 0 && _map_filter_rebuild(map, initial_capacity) != MAP_SUCCESS) {
+        map->ops->destroy(map);
+        free(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+/**
+ * @brief Records an inserted key in the map's filter, if it has one.
+ * A filter that now holds more entries than it was sized for is rebuilt at twice
+ * the size, so its false positive rate stays near the configured one.
+ * @param map Pointer to the map.
+ * @param hash Hash of the inserted key.
+ */
+static void _map_filter_note_insert(map_t *map, uint64_t hash) {
+    if (map->filter == NULL) return;
+
+    _map_filter_add(map, hash);
+    if (map->size > map->filter_capacity) {
+        // A failed rebuild keeps the old filter: fuller, but still correct
+        _map_filter_rebuild(map, map->size * 2);
+    }
+}
+
+/**
+ * @brief Address of the key stored next to a value returned by an engine's entry or find.
+ * @param map Pointer to the map.
+ * @param value Address of the entry's value.
+ * @return Address of the entry's key.
+ */
+static void **_map_stored_key(const map_t *map, void **value) {
+    if (map->ops == &map_swiss_engine) {
+        return &((map_swiss_slot_t *)((char *)value - offsetof(map_swiss_slot_t, value)))->key;
+    }
+    if (map->ops == &map_robin_engine) {
+        return &((map_robin_slot_t *)((char *)value - offsetof(map_robin_slot_t, value)))->key;
+    }
+    return &((map_node_t *)((char *)value - offsetof(map_node_t, value)))->key;
+}
+
+/**
+ * @brief Finds a prepared key, or inserts it with a NULL value.
+ * Maps with copy_keys store a copy of a new key from their arena instead of `key`.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key to store if it is absent.
+ * @param inserted Receives 1 if the key was inserted, 0 if it already existed.
+ * @return The address of the value, or NULL on allocation failure.
+ */
+void **_map_entry_lookup(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    void **stored = map->ops->entry(map, lookup, key, inserted);
+    if (stored == NULL || !*inserted) {
+        return stored;
+    }
+
+    if (map->copy_keys) {
+        // Only a new entry takes a copy, swapped in for the caller's equal key.
+        // The NUL after it lets the plain functions read the key back as a string.
+        void *copy = _map_arena_copy(&map->key_arena, key, lookup->key_len, 1);
+        if (copy == NULL) {
+            map->ops->remove(map, lookup); // Frees nothing: no key free function, NULL value
+            return NULL;
+        }
+        *_map_stored_key(map, stored) = copy;
+    }
+    _map_filter_note_insert(map, lookup->hash);
+    return stored;
+}
+
+/**
+ * @brief Inserts a prepared key and records it in the map's filter.
+ * Maps with copy_keys store a copy of new keys from their arena instead of `key`.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure.
+ */
+map_result_t _map_insert_lookup(map_t *map, const map_lookup_t *lookup, void *key, void *value) {
+    if (map->copy_keys) {
+        // An update keeps the key already stored, so only the value is replaced
+        int inserted;
+        void **stored = _map_entry_lookup(map, lookup, key, &inserted);
+        if (stored == NULL) {
+            return MAP_ALLOCATION_ERROR;
+        }
+        if (!inserted && map->value_free_func && *stored) {
+            map->value_free_func(*stored);
+        }
+        *stored = value;
+        return MAP_SUCCESS;
+    }
+
+    map_result_t res = map->ops->insert(map, lookup, key, value);
+    if (res == MAP_SUCCESS) {
+        _map_filter_note_insert(map, lookup->hash);
+    }
+    return res;
+}
+
+/**
+ * @brief Finds a prepared key. A definite miss in the filter skips the engine entirely.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @return Address of the stored value, or NULL if the key is not found.
+ */
+void **_map_find_lookup(const map_t *map, const map_lookup_t *lookup) {
+    if (!_map_filter_may_contain(map, lookup->hash)) {
+        return NULL;
+    }
+    return map->ops->find(map, lookup);
+}
+
+/**
+ * @brief Removes a prepared key and applies the auto-shrink policy.
+ * Shrinking starts below 1/AUTO_SHRINK_DIVISOR load and targets room for twice
+ * the remaining entries, far from the growth threshold, so alternating inserts
+ * and deletes around one size do not resize back and forth.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found.
+ */
+map_result_t _map_remove(map_t *map, const map_lookup_t *lookup) {
+    map_result_t res = map->ops->remove(map, lookup);
+    if (res == MAP_SUCCESS && map->auto_shrink &&
+        map->capacity > AUTO_SHRINK_MIN_CAPACITY && map->size < map->capacity / AUTO_SHRINK_DIVISOR) {
+        // A failed shrink leaves the map as it was, which is still valid
+        map->ops->reserve(map, map->size * 2, 1);
+    }
+    return res;
+}
+
+/**
+ * @brief Destroys the hash map and frees all associated memory.
+ * Frees each entry and its associated key/value data if free functions are provided.
+ * @param map Pointer to the map to destroy.
+ */
+void map_destroy(map_t *map) {
+    if (map == NULL) return;
+
+    map->ops->destroy(map);
+    _map_arena_release(&map->key_arena);
+    free(map->filter_alloc);
+    free(map);
+}
+
+/**
+ * @brief Inserts a key-value pair into the map. If the key already exists, its value is updated.
+ * Handles automatic resizing if the load factor threshold is exceeded.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure.
+ */
+map_result_t map_insert(map_t *map, void *key, void *value) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, _map_default_key_len(map, key), &lookup);
+    return _map_insert_lookup(map, &lookup, key, value);
+}
+
+/**
+ * @brief Inserts a key of explicit length into a MAP_KEY_BYTES map.
+ * The map stores the key pointer, so the bytes must stay valid while the entry exists.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_insert_n(map_t *map, void *key, size_t key_len, void *value) {
+    if (map == NULL || key == NULL || map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, key_len, &lookup);
+    return _map_insert_lookup(map, &lookup, key, value);
+}
+
+/**
+ * @brief Finds a key, inserting it with a NULL value if absent, and returns its value slot.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param inserted Optional: Receives 1 if the key was inserted, 0 if it already existed. Can be NULL.
+ * @return The address of the key's value, or NULL on allocation failure or invalid input.
+ */
+void **map_entry(map_t *map, void *key, int *inserted) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    int was_inserted;
+    _map_make_lookup(map, key, _map_default_key_len(map, key), &lookup);
+    void **value = _map_entry_lookup(map, &lookup, key, &was_inserted);
+    if (value != NULL && inserted != NULL) {
+        *inserted = was_inserted;
+    }
+    return value;
+}
+
+/**
+ * @brief Like map_entry, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param inserted Optional: Receives 1 if the key was inserted, 0 if it already existed. Can be NULL.
+ * @return The address of the key's value, or NULL on allocation failure or invalid input.
+ */
+void **map_entry_n(map_t *map, void *key, size_t key_len, int *inserted) {
+    if (map == NULL || key == NULL || map->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    int was_inserted;
+    _map_make_lookup(map, key, key_len, &lookup);
+    void **value = _map_entry_lookup(map, &lookup, key, &was_inserted);
+    if (value != NULL && inserted != NULL) {
+        *inserted = was_inserted;
+    }
+    return value;
+}
+
+/**
+ * @brief Applies an update function to the value slot of a prepared key.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key to store if it is absent.
+ * @param update_func Computes the new value from the current one.
+ * @param context User-defined pointer passed to update_func.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure.
+ */
+static map_result_t _map_update_lookup(map_t *map, const map_lookup_t *lookup, void *key,
+                                       map_update_func_t update_func, void *context) {
+    int inserted;
+    void **value = _map_entry_lookup(map, lookup, key, &inserted);
+    if (value == NULL) {
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    void *old_value = *value;
+    void *new_value = update_func(old_value, inserted, context);
+    if (map->value_free_func && old_value && old_value != new_value) {
+        map->value_free_func(old_value);
+    }
+    *value = new_value;
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Replaces the value of a key with update_func(value, inserted, context), inserting the key if absent.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param update_func Computes the new value from the current one.
+ * @param context User-defined pointer passed to update_func.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_update_with(map_t *map, void *key, map_update_func_t update_func, void *context) {
+    if (map == NULL || key == NULL || update_func == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, _map_default_key_len(map, key), &lookup);
+    return _map_update_lookup(map, &lookup, key, update_func, context);
+}
+
+/**
+ * @brief Like map_update_with, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param update_func Computes the new value from the current one.
+ * @param context User-defined pointer passed to update_func.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_update_with_n(map_t *map, void *key, size_t key_len, map_update_func_t update_func, void *context) {
+    if (map == NULL || key == NULL || update_func == NULL || map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, key_len, &lookup);
+    return _map_update_lookup(map, &lookup, key, update_func, context);
+}
+
+/**
+ * @brief Retrieves the value associated with a given key.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *map_get(const map_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, _map_default_key_len(map, key), &lookup);
+    void **value = _map_find_lookup(map, &lookup);
+    return (value != NULL) ? *value : NULL;
+}
+
+/**
+ * @brief Retrieves the value associated with a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *map_get_n(const map_t *map, const void *key, size_t key_len) {
+    if (map == NULL || key == NULL || map->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, key_len, &lookup);
+    void **value = _map_find_lookup(map, &lookup);
+    return (value != NULL) ? *value : NULL;
+}
+
+/**
+ * @brief Checks if a key exists in the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int map_contains(const map_t *map, const void *key) {
+    return map_get(map, key) != NULL;
+}
+
+/**
+ * @brief Checks if a key of explicit length exists in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int map_contains_n(const map_t *map, const void *key, size_t key_len) {
+    return map_get_n(map, key, key_len) != NULL;
+}
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * Optionally frees the key and value memory if free functions are set.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t map_delete(map_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, _map_default_key_len(map, key), &lookup);
+    return _map_remove(map, &lookup);
+}
+
+/**
+ * @brief Deletes a key of explicit length from a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t map_delete_n(map_t *map, const void *key, size_t key_len) {
+    if (map == NULL || key == NULL || map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map, key, key_len, &lookup);
+    return _map_remove(map, &lookup);
+}
+
+/**
+ * @brief Resolves one window of a batch lookup.
+ * All keys of the window are hashed and their first cache lines prefetched
+ * before any of them is resolved, so the misses overlap instead of queueing.
+ * @param map Pointer to the map.
+ * @param keys Keys of the window.
+ * @param n Number of keys, at most BATCH_WINDOW.
+ * @param out_values Receives the value of each key, or NULL if not found.
+ */
+static void _map_get_window(const map_t *map, const void *const *keys, size_t n, void **out_values) {
+    map_lookup_t lookups[BATCH_WINDOW];
+    unsigned char keys_missing[BATCH_WINDOW] = {0};
+
+    for (size_t i = 0; i < n; ++i) {
+        if (keys[i] == NULL) continue;
+        _map_make_lookup(map, keys[i], _map_default_key_len(map, keys[i]), &lookups[i]);
+        if (_map_filter_may_contain(map, lookups[i].hash)) {
+            map->ops->prefetch(map, &lookups[i]);
+        } else {
+            keys_missing[i] = 1; // Definite miss: no prefetch, no probe
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        void **value = (keys[i] != NULL && !keys_missing[i]) ? map->ops->find(map, &lookups[i]) : NULL;
+        out_values[i] = (value != NULL) ? *value : NULL;
+    }
+}
+
+/**
+ * @brief Retrieves the values of many keys at once.
+ * @param map Pointer to the map.
+ * @param keys Array of n keys. NULL keys are reported as not found.
+ * @param n Number of keys.
+ * @param out_values Array of n entries; receives each value, or NULL if the key is not found.
+ * @return The number of keys found.
+ */
+size_t map_get_batch(const map_t *map, const void *const *keys, size_t n, void **out_values) {
+    if (map == NULL || keys == NULL || out_values == NULL) {
+        return 0;
+    }
+
+    size_t found = 0;
+    for (size_t start = 0; start < n; start += BATCH_WINDOW) {
+        size_t count = (n - start < BATCH_WINDOW) ? n - start : BATCH_WINDOW;
+        _map_get_window(map, keys + start, count, out_values + start);
+        for (size_t i = start; i < start + count; ++i) {
+            found += (out_values[i] != NULL);
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Checks many keys at once.
+ * @param map Pointer to the map.
+ * @param keys Array of n keys. NULL keys are reported as not found.
+ * @param n Number of keys.
+ * @param out_found Array of n entries; receives 1 for each key that exists, 0 otherwise.
+ * @return The number of keys found.
+ */
+size_t map_contains_batch(const map_t *map, const void *const *keys, size_t n, int *out_found) {
+    if (map == NULL || keys == NULL || out_found == NULL) {
+        return 0;
+    }
+
+    void *values[BATCH_WINDOW];
+    size_t found = 0;
+    for (size_t start = 0; start < n; start += BATCH_WINDOW) {
+        size_t count = (n - start < BATCH_WINDOW) ? n - start : BATCH_WINDOW;
+        _map_get_window(map, keys + start, count, values);
+        for (size_t i = 0; i < count; ++i) {
+            out_found[start + i] = (values[i] != NULL);
+            found += (values[i] != NULL);
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Pre-sizes the map so that it holds at least n entries without resizing.
+ * @param map Pointer to the map.
+ * @param n Number of entries to make room for.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_reserve(map_t *map, size_t n) {
+    if (map == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_result_t res = map->ops->reserve(map, n, 0);
+    if (res == MAP_SUCCESS && map->filter != NULL && n > map->filter_capacity) {
+        res = _map_filter_rebuild(map, n);
+    }
+    return res;
+}
+
+/**
+ * @brief Shrinks the map's storage to the smallest capacity that holds its current entries.
+ * @param map Pointer to the map.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_shrink_to_fit(map_t *map) {
+    if (map == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_result_t res = map->ops->reserve(map, map->size, 1);
+    if (res == MAP_SUCCESS && map->filter != NULL) {
+        res = _map_filter_rebuild(map, map->size);
+    }
+    return res;
+}
+
+/**
+ * @brief Rebuilds the map's Bloom filter from the keys currently stored.
+ * @param map Pointer to the map.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_rebuild_filter(map_t *map) {
+    if (map == NULL || map->filter == NULL) {
+        return MAP_FAILURE;
+    }
+    return _map_filter_rebuild(map, map->size * 2);
+}
+
+/**
+ * @brief Returns the number of key-value pairs in the map.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t map_size(const map_t *map) {
+    return (map != NULL) ? map->size : 0;
+}
+
+/**
+ * @brief Iterates over all key-value pairs in the map, calling a callback function for each.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * Iteration stops if this function returns a non-zero value.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t map_iterate(const map_t *map, map_iter_func_t callback_func, void *user_data) {
+    if (map == NULL || callback_func == NULL) {
+        return MAP_FAILURE;
+    }
+
+    return map->ops->iterate(map, callback_func, user_data);
+}
+
+// Shared state of map_for_each_parallel.
+typedef struct {
+    const map_t *map;
+    map_accum_func_t callback_func;
+    unsigned char *accumulators; // One padded copy per worker, or NULL
+    size_t stride;             // Bytes between consecutive copies
+} map_scan_job_t;
+
+static void _map_scan_range(void *context, size_t worker, size_t begin, size_t end) {
+    map_scan_job_t *job = (map_scan_job_t *)context;
+    void *accumulator = (job->accumulators != NULL) ? job->accumulators + worker * job->stride : NULL;
+    job->map->ops->scan_range(job->map, begin, end, job->callback_func, accumulator);
+}
+
+/**
+ * @brief Visits every entry on several threads and combines per-thread results.
+ * @param map Pointer to the map.
+ * @param threads Maximum number of threads, including the caller.
+ * @param callback_func The function to call for each key-value pair.
+ * @param reduce_func Function that folds one accumulator into another.
+ * @param accumulator Identity value on entry, combined result on return. Can be NULL.
+ * @param accumulator_size Size of the accumulator in bytes.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR or MAP_FAILURE on error.
+ */
+map_result_t map_for_each_parallel(
+    const map_t *map,
+    size_t threads,
+    map_accum_func_t callback_func,
+    map_reduce_func_t reduce_func,
+    void *accumulator,
+    size_t accumulator_size) {
+    if (map == NULL || callback_func == NULL || (accumulator != NULL && reduce_func == NULL)) {
+        return MAP_FAILURE;
+    }
+
+    size_t units = map->capacity + map->old_capacity;
+    size_t chunks = units / PARALLEL_SCAN_CHUNK + (units % PARALLEL_SCAN_CHUNK != 0);
+    if (threads > chunks) {
+        threads = chunks;
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    map_scan_job_t job = { map, callback_func, NULL, 0 };
+    if (accumulator != NULL) {
+        // Pad each copy so workers never write to the same cache line
+        job.stride = (accumulator_size + PARALLEL_SCAN_ALIGN - 1) / PARALLEL_SCAN_ALIGN * PARALLEL_SCAN_ALIGN;
+        if (job.stride == 0) {
+            job.stride = PARALLEL_SCAN_ALIGN;
+        }
+        job.accumulators = (unsigned char *)malloc(threads * job.stride);
+        if (job.accumulators == NULL) {
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate scan accumulators.\n");
+            return MAP_ALLOCATION_ERROR;
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            memcpy(job.accumulators + i * job.stride, accumulator, accumulator_size);
+        }
+    }
+
+    size_t workers = _map_parallel_for(threads, units, PARALLEL_SCAN_CHUNK, _map_scan_range, &job);
+
+    if (job.accumulators != NULL) {
+        for (size_t i = 0; i < workers; ++i) {
+            reduce_func(accumulator, job.accumulators + i * job.stride);
+        }
+        free(job.accumulators);
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Starts an external iteration over the map.
+ * @param map Pointer to the map.
+ * @param it Cursor to initialize.
+ */
+void map_iter_begin(map_t *map, map_iter_t *it) {
+    if (it == NULL) return;
+
+    memset(it, 0, sizeof(*it));
+    it->map = map;
+    if (map != NULL) {
+        map->ops->iter_begin(map, it);
+    }
+}
+
+/**
+ * @brief Advances the cursor to the next entry.
+ * @param it Cursor started with map_iter_begin.
+ * @return 1 if it->key and it->value now hold the next entry, 0 at the end.
+ */
+int map_iter_next(map_iter_t *it) {
+    if (it == NULL || it->map == NULL) {
+        return 0;
+    }
+    if (!it->map->ops->iter_next(it->map, it)) {
+        it->key = NULL;
+        it->value = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Removes the current entry of an iteration.
+ * @param it Cursor positioned on an entry.
+ * @return MAP_SUCCESS on success, MAP_FAILURE if the cursor is not on an entry.
+ */
+map_result_t map_iter_remove(map_iter_t *it) {
+    if (it == NULL || it->map == NULL || it->key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup = { it->key, it->key_len, it->hash };
+    // Bypasses _map_remove on purpose: an auto-shrink would invalidate the cursor
+    map_result_t res = it->map->ops->remove(it->map, &lookup);
+    it->key = NULL; // The key may have just been freed
+    it->value = NULL;
+    return (res == MAP_SUCCESS) ? MAP_SUCCESS : MAP_FAILURE;
+}
+
+/**
+ * @brief Ends an iteration.
+ * @param it Cursor started with map_iter_begin.
+ */
+void map_iter_end(map_iter_t *it) {
+    if (it == NULL) return;
+    memset(it, 0, sizeof(*it));
+}
+
+// Secret constants of wyhash (final version 4), public domain.
+static const uint64_t _wyp[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+/**
+ * @brief Full 64x64 -> 128-bit multiply; A receives the low half, B the high half.
+ */
+static inline void _wy_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t _wy_mix(uint64_t a, uint64_t b) {
+    _wy_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t _wy_read8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t _wy_read4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t _wy_read3(const uint8_t *p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+/**
+ * @brief wyhash over a byte range: reads 8 bytes (up to 48 per round) at a time.
+ * @param data Pointer to the bytes.
+ * @param len Number of bytes.
+ * @param seed Seed mixed into the state.
+ * @return The hash value.
+ */
+static uint64_t _wyhash(const void *data, size_t len, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t a, b;
+    seed ^= _wy_mix(seed ^ _wyp[0], _wyp[1]);
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (_wy_read4(p) << 32) | _wy_read4(p + ((len >> 3) << 2));
+            b = (_wy_read4(p + len - 4) << 32) | _wy_read4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = _wy_read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = _wy_mix(_wy_read8(p) ^ _wyp[1], _wy_read8(p + 8) ^ seed);
+                see1 = _wy_mix(_wy_read8(p + 16) ^ _wyp[2], _wy_read8(p + 24) ^ see1);
+                see2 = _wy_mix(_wy_read8(p + 32) ^ _wyp[3], _wy_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = _wy_mix(_wy_read8(p) ^ _wyp[1], _wy_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = _wy_read8(p + i - 16);
+        b = _wy_read8(p + i - 8);
+    }
+
+    a ^= _wyp[1];
+    b ^= seed;
+    _wy_mum(&a, &b);
+    return _wy_mix(a ^ _wyp[0] ^ len, b ^ _wyp[1]);
+}
+
+/**
+ * @brief Hash function for byte ranges of explicit length (wyhash).
+ * Processes the input a machine word at a time and has full avalanche, so the
+ * result can be masked directly.
+ * @param data Pointer to the bytes; need not be NUL-terminated.
+ * @param len Number of bytes.
+ * @return The hash value.
+ */
+uint64_t hash_bytes(const void *data, size_t len) {
+    return _wyhash(data, len, 0);
+}
+
+/**
+ * @brief hash_bytes with an explicit seed, for formats that record their seed.
+ */
+uint64_t _map_hash_bytes_seeded(const void *data, size_t len, uint64_t seed) {
+    return _wyhash(data, len, seed);
+}
+
+#define _SIP_ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+#define _SIP_ROUND(v0, v1, v2, v3) do {                                          \
+        v0 += v1; v1 = _SIP_ROTL(v1, 13); v1 ^= v0; v0 = _SIP_ROTL(v0, 32);      \
+        v2 += v3; v3 = _SIP_ROTL(v3, 16); v3 ^= v2;                              \
+        v0 += v3; v3 = _SIP_ROTL(v3, 21); v3 ^= v0;                              \
+        v2 += v1; v1 = _SIP_ROTL(v1, 17); v1 ^= v2; v2 = _SIP_ROTL(v2, 32);      \
+    } while (0)
+
+/**
+ * @brief SipHash-1-3: one compression round per 8-byte word, three finalization rounds.
+ * @param data Pointer to the bytes; need not be NUL-terminated.
+ * @param len Number of bytes.
+ * @param key The 128-bit secret key.
+ * @return The hash value.
+ */
+uint64_t _map_siphash13(const void *data, size_t len, const uint64_t key[2]) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t v0 = key[0] ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = key[1] ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = key[0] ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = key[1] ^ 0x7465646279746573ULL;
+
+    size_t i = len;
+    for (; i >= 8; i -= 8, p += 8) {
+        uint64_t m = _wy_read8(p);
+        v3 ^= m;
+        _SIP_ROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    // Last word: remaining bytes, little endian, with the length in the top byte
+    uint64_t m = (uint64_t)len << 56;
+    for (size_t j = 0; j < i; ++j) {
+        m |= (uint64_t)p[j] << (8 * j);
+    }
+    v3 ^= m;
+    _SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= m;
+
+    v2 ^= 0xff;
+    _SIP_ROUND(v0, v1, v2, v3);
+    _SIP_ROUND(v0, v1, v2, v3);
+    _SIP_ROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * @brief Hash function for C-style strings.
  * @param key Pointer to the string key.
  * @return The hash value.
  */
 unsigned long hash_string(const void *key) {
     const char *str = (const char *)key;
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
-    }
-    return hash;
+    return (unsigned long)hash_bytes(str, strlen(str));
 }
 
 /**
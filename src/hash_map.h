@@ -2,6 +2,7 @@
 #define HASH_MAP_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 // Enum for map operation results
 typedef enum {
@@ -32,6 +33,93 @@ typedef void (*free_func_t)(void *data);
 // Returns 0 to continue iteration, non-zero to stop.
 typedef int (*map_iter_func_t)(const void *key, void *value, void *user_data);
 
+// Function pointer for parallel scans (map_for_each_parallel)
+// Called once per entry with the accumulator of the worker thread visiting it.
+typedef void (*map_accum_func_t)(const void *key, void *value, void *accumulator);
+
+// Function pointer for combining the accumulators of a parallel scan
+// Folds the accumulator `src` into `dst`.
+typedef void (*map_reduce_func_t)(void *dst, const void *src);
+
+// Function pointer for map_update_with
+// Receives the current value (NULL if `inserted` is non-zero, meaning the key was
+// just added) and returns the value to store.
+typedef void *(*map_update_func_t)(void *value, int inserted, void *context);
+
+// Cursor for external iteration (map_iter_begin / map_iter_next / map_iter_end).
+// After map_iter_next returns 1, key, key_len and value describe the current entry.
+typedef struct {
+    const void *key;           // Current key
+    size_t key_len;            // Current key length (MAP_KEY_BYTES only)
+    void *value;               // Current value
+
+    // Private cursor state
+    map_t *map;
+    void *node;                // Chained engine: next node to visit
+    size_t pos;                // Open-addressing engines: next slot to visit
+    size_t remaining;          // Open-addressing engines: slots left to visit
+    uint64_t hash;             // Hash of the current entry
+} map_iter_t;
+
+// Storage engine used behind the map_t API
+typedef enum {
+    MAP_ENGINE_CHAINED = 0, // Separate chaining: one heap node per entry (default)
+    MAP_ENGINE_SWISS,       // Open addressing: flat slot array probed 16 control bytes at a time
+    MAP_ENGINE_ROBIN_HOOD   // Open addressing: Robin Hood linear probing with backward-shift deletion
+} map_engine_t;
+
+// How a map hashes and compares its keys
+typedef enum {
+    MAP_KEY_OPAQUE = 0, // Keys go through hash_func and compare_func (default)
+    MAP_KEY_BYTES       // Keys are byte ranges: hashed with hash_bytes, compared by length and memcmp.
+                        // hash_func and compare_func may be NULL. Use the *_n functions for keys of
+                        // explicit length; the plain functions treat keys as NUL-terminated strings.
+} map_key_mode_t;
+
+// Creation options for map_create_with_options.
+// A zero-initialized struct selects the defaults used by map_create.
+typedef struct {
+    map_engine_t engine; // Storage engine
+    // Non-zero to grow incrementally: after a resize the old bucket array is kept
+    // and every insert, get and delete migrates a few buckets, so no single
+    // operation pays for rehashing the whole map. Requires MAP_ENGINE_CHAINED.
+    // Note that map_get and map_contains then modify the map internally.
+    int incremental_resize;
+    // Non-zero to round the bucket count up to a power of two and index with a
+    // mask instead of a modulo. Every hash_func result is then run through a
+    // 64-bit mixing finalizer, so weak hashes such as hash_int still spread
+    // evenly. The open-addressing engines always work this way.
+    int pow2_capacity;
+    map_key_mode_t key_mode; // How keys are hashed and compared
+    // Non-zero to give memory back after mass deletes: once fewer than 1/8 of the
+    // buckets or slots are in use, the map shrinks to twice its remaining size.
+    int auto_shrink;
+    // Number of threads, including the caller, that rehash a chained map when it
+    // grows by a whole multiple of its bucket count. Each old bucket only feeds
+    // new buckets of its own residue class, so workers claim ranges of old buckets
+    // and migrate them without locks. Only large maps use it; 0 or 1 rehashes on
+    // the calling thread. Ignored with incremental_resize.
+    size_t resize_threads;
+    // Bits per entry of a blocked Bloom filter checked before every lookup, or 0
+    // for none. Each key sets 8 bits within one 64-byte block, so a definite miss
+    // costs one cache line and no compare_func calls; 10 bits per key gives about
+    // 1% false positives. Deleted keys stay in the filter until map_rebuild_filter.
+    size_t bloom_bits_per_key;
+    // Non-zero to let the map own its keys: each new key is copied into an
+    // append-only arena of large chunks that map_destroy frees in one go, so
+    // callers neither strdup keys nor pass a key_free_func (which must be NULL).
+    // Callers may reuse or free their key buffer right after an insert. Requires
+    // MAP_KEY_BYTES, since opaque keys have no length to copy by. Space of deleted
+    // keys is only reclaimed when the map is destroyed.
+    int copy_keys;
+    // Non-zero to hash keys with SipHash-1-3 under a secret seed drawn when the map
+    // is created, for maps keyed by untrusted input: without the seed, nobody can
+    // craft keys that collide. A chained map also watches its chains and, if an
+    // insert ever leaves one longer than 16 nodes, draws a new seed and rehashes in
+    // place, so lookups stay short even if the seed leaks. Requires MAP_KEY_BYTES.
+    int keyed_hash;
+} map_options_t;
+
 /**
  * @brief Creates and initializes a new hash map.
  * @param initial_capacity The initial number of buckets. If 0, uses a default.
@@ -48,6 +136,24 @@ map_t *map_create(
     free_func_t key_free_func, 
     free_func_t value_free_func);
 
+/**
+ * @brief Creates and initializes a new hash map with explicit options.
+ * @param initial_capacity The initial number of buckets or slots. If 0, uses a default.
+ * @param hash_func Function to hash keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param compare_func Function to compare keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
+ * @param options Optional: Creation options. NULL selects the defaults.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+map_t *map_create_with_options(
+    size_t initial_capacity,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options);
+
 /**
  * @brief Destroys the hash map and frees all associated memory.
  * @param map Pointer to the map to destroy.
@@ -63,6 +169,66 @@ void map_destroy(map_t *map);
  */
 map_result_t map_insert(map_t *map, void *key, void *value);
 
+/**
+ * @brief Inserts a key of explicit length into a MAP_KEY_BYTES map. If the key already exists, its value is updated.
+ * The map stores the key pointer, so the bytes must stay valid while the entry exists.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_insert_n(map_t *map, void *key, size_t key_len, void *value);
+
+/**
+ * @brief Finds a key, inserting it with a NULL value if absent, and returns its value slot.
+ * The key is hashed and probed once, so read-modify-write updates such as
+ * counters need no separate map_get and map_insert. When the key is inserted the
+ * map stores `key` like map_insert does; when it already exists the stored key is
+ * kept and `key` stays owned by the caller. Freeing any value found in the slot
+ * before overwriting it is up to the caller.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param inserted Optional: Receives 1 if the key was inserted, 0 if it already existed. Can be NULL.
+ * @return The address of the key's value, valid until the map is next modified,
+ *         or NULL on allocation failure or invalid input.
+ */
+void **map_entry(map_t *map, void *key, int *inserted);
+
+/**
+ * @brief Like map_entry, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param inserted Optional: Receives 1 if the key was inserted, 0 if it already existed. Can be NULL.
+ * @return The address of the key's value, or NULL on allocation failure or invalid input.
+ */
+void **map_entry_n(map_t *map, void *key, size_t key_len, int *inserted);
+
+/**
+ * @brief Replaces the value of a key with update_func(value, inserted, context), inserting the key if absent.
+ * Hashes and probes once, like map_entry, with the same key ownership rules. If
+ * update_func returns a different pointer than the old value, the old value is
+ * freed through value_free_func.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param update_func Computes the new value from the current one.
+ * @param context User-defined pointer passed to update_func.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_update_with(map_t *map, void *key, map_update_func_t update_func, void *context);
+
+/**
+ * @brief Like map_update_with, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param update_func Computes the new value from the current one.
+ * @param context User-defined pointer passed to update_func.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_update_with_n(map_t *map, void *key, size_t key_len, map_update_func_t update_func, void *context);
+
 /**
  * @brief Retrieves the value associated with a given key.
  * @param map Pointer to the map.
@@ -71,6 +237,16 @@ map_result_t map_insert(map_t *map, void *key, void *value);
  */
 void *map_get(const map_t *map, const void *key);
 
+/**
+ * @brief Retrieves the value associated with a key of explicit length in a MAP_KEY_BYTES map.
+ * The key can be a slice of a larger buffer; nothing is copied.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *map_get_n(const map_t *map, const void *key, size_t key_len);
+
 /**
  * @brief Checks if a key exists in the map.
  * @param map Pointer to the map.
@@ -79,6 +255,15 @@ void *map_get(const map_t *map, const void *key);
  */
 int map_contains(const map_t *map, const void *key);
 
+/**
+ * @brief Checks if a key of explicit length exists in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int map_contains_n(const map_t *map, const void *key, size_t key_len);
+
 /**
  * @brief Deletes a key-value pair from the map.
  * @param map Pointer to the map.
@@ -87,6 +272,63 @@ int map_contains(const map_t *map, const void *key);
  */
 map_result_t map_delete(map_t *map, const void *key);
 
+/**
+ * @brief Deletes a key of explicit length from a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t map_delete_n(map_t *map, const void *key, size_t key_len);
+
+/**
+ * @brief Retrieves the values of many keys at once.
+ * Keys are hashed and their buckets prefetched in windows before being resolved,
+ * so the cache misses of independent lookups overlap.
+ * @param map Pointer to the map.
+ * @param keys Array of n keys. NULL keys are reported as not found.
+ * @param n Number of keys.
+ * @param out_values Array of n entries; receives each value, or NULL if the key is not found.
+ * @return The number of keys found.
+ */
+size_t map_get_batch(const map_t *map, const void *const *keys, size_t n, void **out_values);
+
+/**
+ * @brief Checks many keys at once, with the same prefetching as map_get_batch.
+ * @param map Pointer to the map.
+ * @param keys Array of n keys. NULL keys are reported as not found.
+ * @param n Number of keys.
+ * @param out_found Array of n entries; receives 1 for each key that exists, 0 otherwise.
+ * @return The number of keys found.
+ */
+size_t map_contains_batch(const map_t *map, const void *const *keys, size_t n, int *out_found);
+
+/**
+ * @brief Pre-sizes the map so that it holds at least n entries without resizing.
+ * Use before a bulk load of known size. Never shrinks the map.
+ * @param map Pointer to the map.
+ * @param n Number of entries to make room for.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_reserve(map_t *map, size_t n);
+
+/**
+ * @brief Shrinks the map's storage to the smallest capacity that holds its current entries.
+ * @param map Pointer to the map.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure, MAP_FAILURE on invalid input.
+ */
+map_result_t map_shrink_to_fit(map_t *map);
+
+/**
+ * @brief Rebuilds the map's Bloom filter from its current keys.
+ * Deletes never clear filter bits, so after many of them misses get rejected
+ * less often; a rebuild restores the configured false positive rate.
+ * @param map Pointer to a map created with bloom_bits_per_key > 0.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure,
+ *         MAP_FAILURE on invalid input or if the map has no filter.
+ */
+map_result_t map_rebuild_filter(map_t *map);
+
 /**
  * @brief Returns the number of key-value pairs in the map.
  * @param map Pointer to the map.
@@ -103,6 +345,67 @@ size_t map_size(const map_t *map);
  */
 map_result_t map_iterate(const map_t *map, map_iter_func_t callback_func, void *user_data);
 
+/**
+ * @brief Visits every entry on up to `threads` threads and combines per-thread results.
+ * The storage (buckets or slots) is split into ranges that worker threads claim in
+ * turn. Each worker starts from its own copy of `accumulator`, padded to a cache
+ * line, and passes it to callback_func for every entry it visits. Afterwards the
+ * copies are folded into `accumulator` with reduce_func in worker order.
+ * The map must not be modified during the call. callback_func may modify the
+ * value it is given but must otherwise be safe to run concurrently with itself.
+ * @param map Pointer to the map.
+ * @param threads Maximum number of threads, including the caller. 0 or 1 scans on the calling thread.
+ * @param callback_func The function to call for each key-value pair.
+ * @param reduce_func Function that folds one accumulator into another. Can be NULL if accumulator is NULL.
+ * @param accumulator On entry, the identity value every worker starts from; on return, the combined
+ *                    result. Can be NULL (callback_func then receives NULL).
+ * @param accumulator_size Size of the accumulator in bytes.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR if the accumulators cannot be allocated,
+ *         MAP_FAILURE on invalid input.
+ */
+map_result_t map_for_each_parallel(
+    const map_t *map,
+    size_t threads,
+    map_accum_func_t callback_func,
+    map_reduce_func_t reduce_func,
+    void *accumulator,
+    size_t accumulator_size);
+
+/**
+ * @brief Starts an external iteration over the map.
+ * Iteration visits every entry exactly once. The chained engine follows an entry
+ * list in insertion order, so it costs O(size); the open-addressing engines scan
+ * their flat slot arrays sequentially. While iterating, only the current entry
+ * may be removed (map_iter_remove); inserting or deleting other keys, or any
+ * resize, invalidates the cursor.
+ * @param map Pointer to the map.
+ * @param it Cursor to initialize.
+ */
+void map_iter_begin(map_t *map, map_iter_t *it);
+
+/**
+ * @brief Advances the cursor to the next entry.
+ * @param it Cursor started with map_iter_begin.
+ * @return 1 if it->key and it->value now hold the next entry, 0 at the end.
+ */
+int map_iter_next(map_iter_t *it);
+
+/**
+ * @brief Removes the current entry, freeing key and value through the map's free functions.
+ * The cursor stays valid; the next call to map_iter_next moves to the following entry.
+ * Does not trigger auto-shrink.
+ * @param it Cursor positioned on an entry.
+ * @return MAP_SUCCESS on success, MAP_FAILURE if the cursor is not on an entry.
+ */
+map_result_t map_iter_remove(map_iter_t *it);
+
+/**
+ * @brief Ends an iteration. The cursor must not be used afterwards.
+ * @param it Cursor started with map_iter_begin.
+ */
+void map_iter_end(map_iter_t *it);
+
+uint64_t hash_bytes(const void *data, size_t len);
 unsigned long hash_string(const void *key);
 int compare_string(const void *key1, const void *key2);
 unsigned long hash_int(const void *key);
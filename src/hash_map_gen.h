@@ -0,0 +1,218 @@
+#ifndef HASH_MAP_GEN_H
+#define HASH_MAP_GEN_H
+
+// Header-only generator for type-specialized hash maps.
+//
+// HASH_MAP_DEFINE(name, K, V, hash_fn, eq_fn) emits a map type `name##_t` whose
+// keys and values are stored inline in a flat slot array (linear probing,
+// backward-shift deletion). Because hashing and equality are expanded at the
+// call site, the compiler can inline them; there is no per-entry allocation
+// and no indirect call, unlike map_t with its void * keys and values.
+//
+//   hash_fn: uint64_t hash_fn(K key). Must spread entropy into the low bits,
+//            since slots are indexed with a mask; hash_map_gen_mix64 helps.
+//   eq_fn:   int eq_fn(K a, K b). Returns non-zero if the keys are equal
+//            (note: the opposite convention of compare_func_t).
+//
+// Example:
+//   HASH_MAP_DEFINE(int_map, int, int, hash_map_gen_hash_int, HASH_MAP_GEN_EQ_SCALAR)
+//   int_map_t m;
+//   int_map_init(&m, 0);
+//   int_map_put(&m, 1, 100);
+//   int *v = int_map_get(&m, 1);
+//   int_map_free(&m);
+//
+// Keys and values are copied by value; the map never frees anything they point to.
+
+#include "hash_map.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HASH_MAP_GEN_MIN_CAPACITY 16 // Capacity is a power of two, at least this large
+#define HASH_MAP_GEN_MAX_LOAD_NUM 3  // Grow when size would exceed 3/4 of capacity
+#define HASH_MAP_GEN_MAX_LOAD_DEN 4
+
+// Equality for scalar keys (integers, pointers, enums).
+#define HASH_MAP_GEN_EQ_SCALAR(a, b) ((a) == (b))
+
+/**
+ * @brief 64-bit mixing finalizer for use in hash_fn.
+ */
+static inline uint64_t hash_map_gen_mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint64_t hash_map_gen_hash_int(int key) {
+    return hash_map_gen_mix64((uint64_t)(unsigned int)key);
+}
+
+static inline uint64_t hash_map_gen_hash_u64(uint64_t key) {
+    return hash_map_gen_mix64(key);
+}
+
+#define HASH_MAP_DEFINE(name, K, V, hash_fn, eq_fn)                                         \
+                                                                                             \
+typedef struct {                                                                             \
+    K key;                                                                                   \
+    V value;                                                                                 \
+} name##_slot_t;                                                                             \
+                                                                                             \
+typedef struct {                                                                             \
+    name##_slot_t *slots;   /* capacity slots */                                             \
+    uint8_t *used;          /* capacity flags, non-zero for a full slot */                   \
+    size_t capacity;        /* Number of slots, a power of two */                            \
+    size_t size;            /* Number of key-value pairs stored */                           \
+} name##_t;                                                                                  \
+                                                                                             \
+/* Allocates storage for `capacity` slots (rounded up to a power of two). */                  \
+static inline map_result_t name##_alloc_(name##_t *map, size_t capacity) {                   \
+    name##_slot_t *slots = (name##_slot_t *)malloc(capacity * sizeof(name##_slot_t));        \
+    uint8_t *used = (uint8_t *)calloc(capacity, 1);                                          \
+    if (slots == NULL || used == NULL) {                                                     \
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate " #name " slots.\n");      \
+        free(slots);                                                                         \
+        free(used);                                                                          \
+        return MAP_ALLOCATION_ERROR;                                                         \
+    }                                                                                        \
+    map->slots = slots;                                                                      \
+    map->used = used;                                                                        \
+    map->capacity = capacity;                                                                \
+    return MAP_SUCCESS;                                                                      \
+}                                                                                            \
+                                                                                             \
+/* Initializes an empty map able to hold `capacity` entries without growing. */              \
+static inline map_result_t name##_init(name##_t *map, size_t capacity) {                     \
+    size_t slots = HASH_MAP_GEN_MIN_CAPACITY;                                                \
+    while (slots / HASH_MAP_GEN_MAX_LOAD_DEN * HASH_MAP_GEN_MAX_LOAD_NUM < capacity) {       \
+        slots <<= 1;                                                                         \
+    }                                                                                        \
+    map->size = 0;                                                                           \
+    return name##_alloc_(map, slots);                                                        \
+}                                                                                            \
+                                                                                             \
+/* Frees the map's storage. */                                                               \
+static inline void name##_free(name##_t *map) {                                              \
+    free(map->slots);                                                                        \
+    free(map->used);                                                                         \
+    map->slots = NULL;                                                                       \
+    map->used = NULL;                                                                        \
+    map->capacity = 0;                                                                       \
+    map->size = 0;                                                                           \
+}                                                                                            \
+                                                                                             \
+/* Returns the slot index of `key`, or capacity if absent. */                                \
+static inline size_t name##_find_(const name##_t *map, K key) {                              \
+    size_t mask = map->capacity - 1;                                                         \
+    size_t index = (size_t)hash_fn(key) & mask;                                              \
+    while (map->used[index]) {                                                               \
+        if (eq_fn(map->slots[index].key, key)) {                                             \
+            return index;                                                                    \
+        }                                                                                    \
+        index = (index + 1) & mask;                                                          \
+    }                                                                                        \
+    return map->capacity;                                                                    \
+}                                                                                            \
+                                                                                             \
+/* Places an entry known to be absent; the caller guarantees a free slot. */                 \
+static inline void name##_place_(name##_t *map, K key, V value) {                            \
+    size_t mask = map->capacity - 1;                                                         \
+    size_t index = (size_t)hash_fn(key) & mask;                                              \
+    while (map->used[index]) {                                                               \
+        index = (index + 1) & mask;                                                          \
+    }                                                                                        \
+    map->used[index] = 1;                                                                    \
+    map->slots[index].key = key;                                                             \
+    map->slots[index].value = value;                                                         \
+}                                                                                            \
+                                                                                             \
+/* Reallocates to `new_capacity` slots and reinserts every entry. */                         \
+static inline map_result_t name##_resize_(name##_t *map, size_t new_capacity) {              \
+    name##_t old = *map;                                                                     \
+    if (name##_alloc_(map, new_capacity) != MAP_SUCCESS) {                                   \
+        return MAP_ALLOCATION_ERROR;                                                         \
+    }                                                                                        \
+    for (size_t i = 0; i < old.capacity; ++i) {                                              \
+        if (old.used[i]) {                                                                   \
+            name##_place_(map, old.slots[i].key, old.slots[i].value);                        \
+        }                                                                                    \
+    }                                                                                        \
+    free(old.slots);                                                                         \
+    free(old.used);                                                                          \
+    return MAP_SUCCESS;                                                                      \
+}                                                                                            \
+                                                                                             \
+/* Inserts a key-value pair; if the key already exists, its value is updated. */             \
+static inline map_result_t name##_put(name##_t *map, K key, V value) {                       \
+    size_t index = name##_find_(map, key);                                                   \
+    if (index != map->capacity) {                                                            \
+        map->slots[index].value = value;                                                     \
+        return MAP_SUCCESS;                                                                  \
+    }                                                                                        \
+    if (map->size + 1 > map->capacity / HASH_MAP_GEN_MAX_LOAD_DEN * HASH_MAP_GEN_MAX_LOAD_NUM) { \
+        map_result_t res = name##_resize_(map, map->capacity * 2);                           \
+        if (res != MAP_SUCCESS) {                                                            \
+            return res;                                                                      \
+        }                                                                                    \
+    }                                                                                        \
+    name##_place_(map, key, value);                                                          \
+    map->size++;                                                                             \
+    return MAP_SUCCESS;                                                                      \
+}                                                                                            \
+                                                                                             \
+/* Returns the address of the value stored for `key`, or NULL if absent. */                  \
+/* The address stays valid until the next put or delete. */                                  \
+static inline V *name##_get(const name##_t *map, K key) {                                    \
+    size_t index = name##_find_(map, key);                                                   \
+    return (index != map->capacity) ? &map->slots[index].value : NULL;                       \
+}                                                                                            \
+                                                                                             \
+static inline int name##_contains(const name##_t *map, K key) {                              \
+    return name##_find_(map, key) != map->capacity;                                          \
+}                                                                                            \
+                                                                                             \
+/* Removes `key`, shifting later entries of its cluster back (no tombstones). */             \
+static inline map_result_t name##_delete(name##_t *map, K key) {                             \
+    size_t hole = name##_find_(map, key);                                                    \
+    if (hole == map->capacity) {                                                             \
+        return MAP_KEY_NOT_FOUND;                                                            \
+    }                                                                                        \
+    size_t mask = map->capacity - 1;                                                         \
+    size_t next = (hole + 1) & mask;                                                         \
+    while (map->used[next]) {                                                                \
+        size_t home = (size_t)hash_fn(map->slots[next].key) & mask;                          \
+        /* Move the entry back unless its home lies cyclically in (hole, next] */            \
+        if (((next - home) & mask) >= ((next - hole) & mask)) {                              \
+            map->slots[hole] = map->slots[next];                                             \
+            hole = next;                                                                     \
+        }                                                                                    \
+        next = (next + 1) & mask;                                                            \
+    }                                                                                        \
+    map->used[hole] = 0;                                                                     \
+    map->size--;                                                                             \
+    return MAP_SUCCESS;                                                                      \
+}                                                                                            \
+                                                                                             \
+static inline size_t name##_size(const name##_t *map) {                                      \
+    return map->size;                                                                        \
+}                                                                                            \
+                                                                                             \
+/* Cursor iteration: start with *pos = 0; returns the next full slot or NULL at the end. */  \
+static inline name##_slot_t *name##_next(const name##_t *map, size_t *pos) {                 \
+    while (*pos < map->capacity) {                                                           \
+        size_t index = (*pos)++;                                                             \
+        if (map->used[index]) {                                                              \
+            return &map->slots[index];                                                       \
+        }                                                                                    \
+    }                                                                                        \
+    return NULL;                                                                             \
+}
+
+#endif // HASH_MAP_GEN_H
@@ -0,0 +1,419 @@
+#ifndef HASH_MAP_INTERNAL_H
+#define HASH_MAP_INTERNAL_H
+
+// Internal definitions shared by the map front end (hash_map.c) and the
+// storage engines. Nothing in here is part of the public API.
+
+#include "hash_map.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Node of the chained engine: one allocation per key-value pair.
+typedef struct map_node_t {
+    void *key;
+    void *value;
+    struct map_node_t *next;
+    uint64_t hash;             // Cached _map_hash_key of the key
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+    struct map_node_t *list_prev; // Entry list in insertion order, for O(size) iteration
+    struct map_node_t *list_next;
+} map_node_t;
+
+// Slab of chained-engine nodes. Nodes are carved from slabs instead of being
+// malloc'd one by one and go back to the pool's free list when deleted.
+typedef struct map_node_slab_t {
+    struct map_node_slab_t *next; // Previously allocated slab
+    size_t count;              // Number of nodes in this slab
+    map_node_t nodes[];        // Node storage
+} map_node_slab_t;
+
+// Per-map node allocator of the chained engine.
+typedef struct map_node_pool_t {
+    map_node_slab_t *slabs;    // Most recent slab first; nodes are carved from its tail
+    size_t slab_used;          // Nodes already carved from the most recent slab
+    map_node_t *free_nodes;    // Released nodes, linked through their next pointer
+} map_node_pool_t;
+
+// Chunk of a key arena. Key bytes are appended back to back.
+typedef struct map_arena_chunk_t {
+    struct map_arena_chunk_t *next; // Previously allocated chunk
+    size_t size;               // Bytes of data in this chunk
+    char data[];               // Key storage
+} map_arena_chunk_t;
+
+// Append-only store for the keys of a copy_keys map. Keys are never freed one
+// by one: their bytes stay until the whole arena is released.
+typedef struct map_key_arena_t {
+    map_arena_chunk_t *chunks; // Most recent chunk first; keys are appended to it
+    size_t used;               // Bytes already used in the most recent chunk
+} map_key_arena_t;
+
+// Slot of the Swiss engine, stored inline in a flat array.
+typedef struct map_swiss_slot_t {
+    void *key;
+    void *value;
+    uint64_t hash;             // Cached _map_hash_key of the key
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+} map_swiss_slot_t;
+
+// Slot of the Robin Hood engine, stored inline in a flat array.
+typedef struct map_robin_slot_t {
+    void *key;
+    void *value;
+    uint64_t hash;             // Cached _map_hash_key of the key
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+    uint32_t dist;             // Probe distance from the home slot plus one; 0 marks an empty slot
+} map_robin_slot_t;
+
+// A key prepared for a lookup: the front end hashes once and hands this to the engine.
+typedef struct map_lookup_t {
+    const void *key;
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+    uint64_t hash;
+} map_lookup_t;
+
+// Operations every storage engine implements.
+typedef struct map_engine_ops_t {
+    // Allocates empty storage for at least `capacity` entries.
+    map_result_t (*init)(map_t *map, size_t capacity);
+    // Frees every entry (through the map's free functions) and the storage itself.
+    void (*destroy)(map_t *map);
+    // Inserts or updates `key` (already hashed into `lookup`).
+    map_result_t (*insert)(map_t *map, const map_lookup_t *lookup, void *key, void *value);
+    // Finds `key`, or inserts it with a NULL value. Sets *inserted accordingly and
+    // returns the address of the value, or NULL if the insert could not allocate.
+    void **(*entry)(map_t *map, const map_lookup_t *lookup, void *key, int *inserted);
+    // Returns the address of the value stored for the key, or NULL if absent.
+    void **(*find)(const map_t *map, const map_lookup_t *lookup);
+    // Removes the key, freeing key and value through the map's free functions.
+    map_result_t (*remove)(map_t *map, const map_lookup_t *lookup);
+    // Visits every entry; stops early when the callback returns non-zero.
+    map_result_t (*iterate)(const map_t *map, map_iter_func_t callback_func, void *user_data);
+    // Issues prefetches for the memory a later find of the key will touch first.
+    void (*prefetch)(const map_t *map, const map_lookup_t *lookup);
+    // Resizes to the engine's preferred capacity for max(entries, size) entries.
+    // Grows when that capacity is larger; shrinks only if `shrink` is non-zero.
+    map_result_t (*reserve)(map_t *map, size_t entries, int shrink);
+    // Positions a cursor before the first entry.
+    void (*iter_begin)(const map_t *map, map_iter_t *it);
+    // Moves a cursor to the next entry and fills its key, key_len, value and hash.
+    // Returns 0 once every entry has been visited. Removing the current entry
+    // must not make the cursor skip or repeat entries.
+    int (*iter_next)(const map_t *map, map_iter_t *it);
+    // Visits the entries stored in units [begin, end) of the storage. Units are the
+    // slots, or for the chained engine the buckets followed by any old buckets of
+    // a pending incremental resize: capacity + old_capacity units in every case.
+    void (*scan_range)(const map_t *map, size_t begin, size_t end, map_accum_func_t callback_func,
+                       void *accumulator);
+} map_engine_ops_t;
+
+extern const map_engine_ops_t map_chained_engine;
+extern const map_engine_ops_t map_swiss_engine;
+extern const map_engine_ops_t map_robin_engine;
+
+// This is the full definition of the map, hidden from users of the header.
+struct map_t {
+    const map_engine_ops_t *ops; // Storage engine selected at creation
+    size_t capacity;           // Buckets (chained) or slots (open addressing)
+    size_t size;               // Current number of key-value pairs stored
+    hash_func_t hash_func;     // Function to hash keys
+    compare_func_t compare_func; // Function to compare keys
+    map_key_mode_t key_mode;   // How keys are hashed and compared
+    free_func_t key_free_func; // Optional: Function to free key memory
+    free_func_t value_free_func; // Optional: Function to free value memory
+    int mix_hash;              // Non-zero if user hashes go through _map_mix64
+    int pow2_capacity;         // Non-zero if capacity is a power of two and indexes are masked
+    int auto_shrink;           // Non-zero to shrink after deletes leave the map sparse
+    size_t resize_threads;     // Threads that rehash a large chained map when it grows
+
+    // Optional blocked Bloom filter over the stored keys (see _map_filter_add)
+    uint64_t *filter;          // filter_blocks blocks of MAP_FILTER_BLOCK_WORDS words, or NULL
+    void *filter_alloc;        // Allocation holding the cache-line aligned filter
+    size_t filter_blocks;      // Number of blocks
+    size_t filter_capacity;    // Entries the filter was sized for; more trigger a rebuild
+    size_t filter_bits_per_key; // Filter bits per entry, 0 if the map has no filter
+
+    int keyed_hash;            // Non-zero if byte keys are hashed with _map_siphash13 under hash_seed
+    uint64_t hash_seed[2];     // Secret key of the keyed hash, drawn at creation and on reseed
+    size_t reseed_chain_length; // Chained engine: reseed once an insert leaves a longer chain; 0 never
+
+    int copy_keys;             // Non-zero if inserted keys are copied into key_arena
+    map_key_arena_t key_arena; // Storage of the copied keys
+
+    // MAP_ENGINE_CHAINED
+    map_node_t **buckets;      // Array of pointers to linked list heads (buckets)
+    map_node_pool_t node_pool; // Allocator for the nodes
+    map_node_t *list_head;     // Oldest node of the entry list
+    map_node_t *list_tail;     // Newest node of the entry list
+    int incremental_resize;    // Non-zero to migrate buckets gradually after a resize
+    map_node_t **old_buckets;  // Bucket array being drained by an incremental resize, or NULL
+    size_t old_capacity;       // Number of buckets in old_buckets
+    size_t rehash_index;       // Old buckets below this index have been migrated
+
+    // MAP_ENGINE_SWISS
+    uint8_t *ctrl;             // capacity + group width control bytes
+    map_swiss_slot_t *slots;   // capacity slots
+    size_t growth_left;        // Inserts into EMPTY slots allowed before a rehash
+
+    // MAP_ENGINE_ROBIN_HOOD
+    map_robin_slot_t *robin_slots; // capacity slots
+};
+
+/**
+ * @brief Hashes bytes like hash_bytes, but with an explicit seed (hash_map.c).
+ * hash_bytes(data, len) equals _map_hash_bytes_seeded(data, len, 0).
+ */
+uint64_t _map_hash_bytes_seeded(const void *data, size_t len, uint64_t seed);
+
+/**
+ * @brief SipHash-1-3 of a byte range under a 128-bit secret key (hash_map.c).
+ * Slower than hash_bytes, but without the key an attacker cannot find colliding inputs.
+ */
+uint64_t _map_siphash13(const void *data, size_t len, const uint64_t key[2]);
+
+/**
+ * @brief Inserts a prepared key and keeps the map's filter up to date (hash_map.c).
+ * Every insert path must go through this rather than ops->insert.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure.
+ */
+map_result_t _map_insert_lookup(map_t *map, const map_lookup_t *lookup, void *key, void *value);
+
+/**
+ * @brief Finds a prepared key, or inserts it with a NULL value (hash_map.c).
+ * Like _map_insert_lookup, this keeps the filter and key arena up to date.
+ * @return Address of the key's value, or NULL on allocation failure.
+ */
+void **_map_entry_lookup(map_t *map, const map_lookup_t *lookup, void *key, int *inserted);
+
+/**
+ * @brief Moves the entry owning a value slot to the back of a chained map's entry list (hash_map.c).
+ * @param map Pointer to a MAP_ENGINE_CHAINED map.
+ * @param value Address of the entry's value, as returned by find or entry.
+ */
+void _map_chained_move_to_back(map_t *map, void **value);
+
+/**
+ * @brief Finds a prepared key, consulting the map's filter first (hash_map.c).
+ * @return Address of the stored value, or NULL if the key is not found.
+ */
+void **_map_find_lookup(const map_t *map, const map_lookup_t *lookup);
+
+/**
+ * @brief Releases every chunk of a key arena at once (hash_map.c).
+ * Keys stored in it become invalid.
+ */
+void _map_arena_release(map_key_arena_t *arena);
+
+/**
+ * @brief Removes a prepared key and applies the map's auto-shrink policy (hash_map.c).
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found.
+ */
+map_result_t _map_remove(map_t *map, const map_lookup_t *lookup);
+
+// Processes items [begin, end) of a parallel job on behalf of worker `worker`.
+typedef void (*map_range_func_t)(void *context, size_t worker, size_t begin, size_t end);
+
+/**
+ * @brief Runs range_func over [0, count) in chunks claimed by up to `threads` threads.
+ * The calling thread takes part as worker 0; the call returns once every chunk is done.
+ * Worker indexes are below the returned count, so callers can size per-worker state
+ * by `threads` up front. Falls back to the calling thread alone if threads cannot
+ * be started. Every call of range_func covers exactly one chunk, [k * chunk,
+ * min((k + 1) * chunk, count)), even on that fallback.
+ * @param threads Maximum number of threads, including the caller.
+ * @param count Number of items.
+ * @param chunk Items claimed at a time.
+ * @param range_func Function processing one chunk.
+ * @param context Passed through to range_func.
+ * @return Number of worker indexes handed out (at least 1).
+ */
+size_t _map_parallel_for(size_t threads, size_t count, size_t chunk,
+                         map_range_func_t range_func, void *context);
+
+/**
+ * @brief 64-bit mixing finalizer (from MurmurHash3's fmix64).
+ * Every input bit affects every output bit. Masked indexing needs this because it
+ * only looks at the low bits, and the Swiss engine takes its tag from the other end.
+ */
+static inline uint64_t _map_mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief Hints the CPU to start loading a cache line; never faults.
+ */
+static inline void _map_prefetch(const void *addr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr, 0, 3);
+#else
+    (void)addr;
+#endif
+}
+
+/**
+ * @brief Rounds a capacity up to a power of two.
+ * @param capacity Requested capacity.
+ * @param minimum Smallest capacity to return, itself a power of two.
+ * @return The smallest power of two that is at least both arguments.
+ */
+static inline size_t _map_round_pow2(size_t capacity, size_t minimum) {
+    size_t rounded = minimum;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+#define MAP_FILTER_BLOCK_WORDS 8   // 64-bit words per filter block: one 64-byte cache line
+
+/**
+ * @brief Picks a key's filter block and sets the key's bit pattern in `pattern`.
+ * Every key sets one bit in each word of a single block, so a lookup touches one
+ * cache line. The hash is mixed again because chained maps may cache raw hashes.
+ * @param map Pointer to the map; it must have a filter.
+ * @param hash Hash of the key, as computed by _map_hash_key.
+ * @param pattern Receives the bit to test or set in each word of the block.
+ * @return Pointer to the first word of the key's block.
+ */
+static inline uint64_t *_map_filter_block(const map_t *map, uint64_t hash, uint64_t pattern[MAP_FILTER_BLOCK_WORDS]) {
+    static const uint32_t salts[MAP_FILTER_BLOCK_WORDS] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+    };
+    uint64_t x = _map_mix64(hash);
+    uint32_t low = (uint32_t)x;
+    for (int i = 0; i < MAP_FILTER_BLOCK_WORDS; ++i) {
+        pattern[i] = 1ULL << ((low * salts[i]) >> 26);
+    }
+    // Multiply-shift maps the top 32 bits onto [0, filter_blocks) without a division
+    size_t block = (size_t)(((x >> 32) * (uint64_t)map->filter_blocks) >> 32);
+    return map->filter + block * MAP_FILTER_BLOCK_WORDS;
+}
+
+/**
+ * @brief Records a key in the map's filter, if it has one.
+ */
+static inline void _map_filter_add(map_t *map, uint64_t hash) {
+    if (map->filter == NULL) return;
+
+    uint64_t pattern[MAP_FILTER_BLOCK_WORDS];
+    uint64_t *block = _map_filter_block(map, hash, pattern);
+    for (int i = 0; i < MAP_FILTER_BLOCK_WORDS; ++i) {
+        block[i] |= pattern[i];
+    }
+}
+
+/**
+ * @brief Checks the map's filter for a key.
+ * @return 0 if the key is definitely absent, non-zero if it may be present
+ *         (always non-zero for maps without a filter).
+ */
+static inline int _map_filter_may_contain(const map_t *map, uint64_t hash) {
+    if (map->filter == NULL) return 1;
+
+    uint64_t pattern[MAP_FILTER_BLOCK_WORDS];
+    const uint64_t *block = _map_filter_block(map, hash, pattern);
+    uint64_t missing = 0;
+    for (int i = 0; i < MAP_FILTER_BLOCK_WORDS; ++i) {
+        missing |= pattern[i] & ~block[i];
+    }
+    return missing == 0;
+}
+
+/**
+ * @brief Hashes a key the way the map's engine expects it.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param key_len Key length in bytes (MAP_KEY_BYTES only).
+ * @return The (optionally mixed) hash of the key.
+ */
+static inline uint64_t _map_hash_key(const map_t *map, const void *key, size_t key_len) {
+    if (map->key_mode == MAP_KEY_BYTES) {
+        // Both are already well mixed
+        return map->keyed_hash ? _map_siphash13(key, key_len, map->hash_seed) : hash_bytes(key, key_len);
+    }
+    uint64_t hash = (uint64_t)map->hash_func(key);
+    return map->mix_hash ? _map_mix64(hash) : hash;
+}
+
+/**
+ * @brief Prepares a lookup for a key, hashing it once.
+ * @param map Pointer to the map whose settings hash the key.
+ * @param key Pointer to the key.
+ * @param key_len Key length in bytes (MAP_KEY_BYTES only).
+ * @param lookup Receives the prepared lookup.
+ */
+static inline void _map_make_lookup(const map_t *map, const void *key, size_t key_len, map_lookup_t *lookup) {
+    lookup->key = key;
+    lookup->key_len = key_len;
+    lookup->hash = _map_hash_key(map, key, key_len);
+}
+
+/**
+ * @brief Length of a key passed to the non-_n functions.
+ * Byte-keyed maps treat such keys as NUL-terminated strings.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @return The key length, or 0 for maps with opaque keys.
+ */
+static inline size_t _map_default_key_len(const map_t *map, const void *key) {
+    return (map->key_mode == MAP_KEY_BYTES) ? strlen((const char *)key) : 0;
+}
+
+/**
+ * @brief Compares a stored key with a lookup key.
+ * Entries cache the full hash of their key, so keys whose hashes differ are
+ * rejected without calling compare_func.
+ * @param map Pointer to the map.
+ * @param stored_hash Cached hash of the stored key.
+ * @param stored_key The stored key.
+ * @param stored_len Length of the stored key (MAP_KEY_BYTES only).
+ * @param lookup The hashed lookup key.
+ * @return Non-zero if the keys are equal.
+ */
+static inline int _map_key_equals(const map_t *map, uint64_t stored_hash, const void *stored_key,
+                                  size_t stored_len, const map_lookup_t *lookup) {
+    if (stored_hash != lookup->hash) {
+        return 0;
+    }
+    if (map->key_mode == MAP_KEY_BYTES) {
+        return stored_len == lookup->key_len && memcmp(stored_key, lookup->key, stored_len) == 0;
+    }
+    return map->compare_func(stored_key, lookup->key) == 0;
+}
+
+/**
+ * @brief Replaces the key and value of an existing entry on insert.
+ * The old value is freed, and so is the old key if the new one is a different pointer.
+ */
+static inline void _map_replace_pair(const map_t *map, void **stored_key, void **stored_value, void *key, void *value) {
+    if (map->value_free_func && *stored_value) {
+        map->value_free_func(*stored_value);
+    }
+    // The caller may pass a fresh copy of a key equal to the stored one
+    if (map->key_free_func && *stored_key != key) {
+        map->key_free_func(*stored_key);
+    }
+    *stored_key = key;
+    *stored_value = value;
+}
+
+/**
+ * @brief Frees a key and value pair through the map's free functions.
+ */
+static inline void _map_free_pair(const map_t *map, void *key, void *value) {
+    if (map->key_free_func && key) {
+        map->key_free_func(key);
+    }
+    if (map->value_free_func && value) {
+        map->value_free_func(value);
+    }
+}
+
+#endif // HASH_MAP_INTERNAL_H
@@ -0,0 +1,90 @@
+#include "hash_map_internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Shared state of one _map_parallel_for call.
+typedef struct {
+    map_range_func_t range_func;
+    void *context;
+    size_t count;
+    size_t chunk;
+    atomic_size_t next;        // Start of the next unclaimed chunk
+} map_parallel_job_t;
+
+typedef struct {
+    map_parallel_job_t *job;
+    size_t worker;
+} map_parallel_worker_t;
+
+/**
+ * @brief Runs every chunk on the calling thread as worker 0.
+ * Still one call per chunk, so callers may key per-chunk state off `begin`.
+ */
+static void _map_parallel_serial(size_t count, size_t chunk, map_range_func_t range_func, void *context) {
+    for (size_t begin = 0; begin < count; begin += chunk) {
+        size_t end = (count - begin > chunk) ? begin + chunk : count;
+        range_func(context, 0, begin, end);
+    }
+}
+
+static void *_map_parallel_worker(void *arg) {
+    map_parallel_worker_t *self = (map_parallel_worker_t *)arg;
+    map_parallel_job_t *job = self->job;
+    for (;;) {
+        size_t begin = atomic_fetch_add_explicit(&job->next, job->chunk, memory_order_relaxed);
+        if (begin >= job->count) {
+            break;
+        }
+        size_t end = (job->count - begin > job->chunk) ? begin + job->chunk : job->count;
+        job->range_func(job->context, self->worker, begin, end);
+    }
+    return NULL;
+}
+
+size_t _map_parallel_for(size_t threads, size_t count, size_t chunk,
+                         map_range_func_t range_func, void *context) {
+    if (chunk == 0) {
+        chunk = 1;
+    }
+    size_t chunks = count / chunk + (count % chunk != 0);
+    if (threads > chunks) {
+        threads = chunks;
+    }
+    if (threads <= 1) {
+        _map_parallel_serial(count, chunk, range_func, context);
+        return 1;
+    }
+
+    map_parallel_job_t job = { range_func, context, count, chunk, 0 };
+    pthread_t *handles = (pthread_t *)malloc((threads - 1) * sizeof(pthread_t));
+    map_parallel_worker_t *workers = (map_parallel_worker_t *)malloc(threads * sizeof(map_parallel_worker_t));
+    if (handles == NULL || workers == NULL) {
+        // Not worth failing over: run everything on the calling thread
+        free(handles);
+        free(workers);
+        _map_parallel_serial(count, chunk, range_func, context);
+        return 1;
+    }
+
+    // The calling thread is worker 0. Chunks are claimed dynamically, so the job
+    // completes even if some threads could not be started.
+    size_t started = 0;
+    for (size_t i = 0; i < threads; ++i) {
+        workers[i].job = &job;
+        workers[i].worker = i;
+    }
+    while (started + 1 < threads &&
+           pthread_create(&handles[started], NULL, _map_parallel_worker, &workers[started + 1]) == 0) {
+        started++;
+    }
+    _map_parallel_worker(&workers[0]);
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(handles[i], NULL);
+    }
+
+    free(handles);
+    free(workers);
+    return threads;
+}
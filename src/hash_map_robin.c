@@ -0,0 +1,290 @@
+#include "hash_map_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Open-addressing engine using Robin Hood linear probing.
+// Every slot records how far its entry sits from its home slot. On insert an
+// entry that is further from home takes the slot of one that is closer ("rich"),
+// which keeps the variance of probe lengths low. A lookup can stop as soon as it
+// meets an entry closer to home than the probe itself: the key would have
+// displaced it. Deletion shifts the following cluster back by one slot instead
+// of leaving tombstones.
+
+#define MIN_CAPACITY 16         // Capacity is a power of two, at least this large
+#define MAX_LOAD_NUM 9          // Maximum load factor 9/10
+#define MAX_LOAD_DEN 10
+
+static inline size_t _robin_max_load(size_t capacity) {
+    return capacity * MAX_LOAD_NUM / MAX_LOAD_DEN;
+}
+
+/**
+ * @brief Places an entry known to be absent, displacing richer entries on the way.
+ * @param map Pointer to the map.
+ * @param entry The entry to place, with its hash set; its dist field is ignored.
+ * @return Index at which the entry itself ended up.
+ */
+static size_t _robin_place(map_t *map, map_robin_slot_t entry) {
+    size_t mask = map->capacity - 1;
+    size_t index = (size_t)entry.hash & mask;
+    size_t placed_at = map->capacity;
+    entry.dist = 1;
+
+    for (;;) {
+        map_robin_slot_t *slot = &map->robin_slots[index];
+        if (slot->dist == 0) {
+            *slot = entry;
+            return (placed_at != map->capacity) ? placed_at : index;
+        }
+        if (slot->dist < entry.dist) {
+            // Take from the rich: the resident is closer to home than we are
+            map_robin_slot_t displaced = *slot;
+            *slot = entry;
+            entry = displaced;
+            if (placed_at == map->capacity) {
+                placed_at = index;
+            }
+        }
+        entry.dist++;
+        index = (index + 1) & mask;
+    }
+}
+
+/**
+ * @brief Finds the slot holding a key.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @return Index of the slot, or map->capacity if the key is not present.
+ */
+static size_t _robin_find_index(const map_t *map, const map_lookup_t *lookup) {
+    size_t mask = map->capacity - 1;
+    size_t index = (size_t)lookup->hash & mask;
+
+    for (uint32_t dist = 1;; ++dist) {
+        const map_robin_slot_t *slot = &map->robin_slots[index];
+        // Empty slots have dist 0, so this also ends the probe on an empty slot
+        if (slot->dist < dist) {
+            return map->capacity;
+        }
+        if (slot->dist == dist && _map_key_equals(map, slot->hash, slot->key, slot->key_len, lookup)) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+/**
+ * @brief Allocates empty slots for the given capacity.
+ * @param map Pointer to the map. Its storage fields are overwritten.
+ * @param capacity Number of slots, a power of two.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure.
+ */
+static map_result_t _robin_alloc(map_t *map, size_t capacity) {
+    map_robin_slot_t *slots = (map_robin_slot_t *)calloc(capacity, sizeof(map_robin_slot_t));
+    if (slots == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate robin hood slots.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+    map->robin_slots = slots;
+    map->capacity = capacity;
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Moves every entry into freshly allocated storage of the given capacity.
+ * @param map Pointer to the map.
+ * @param new_capacity Number of slots, a power of two large enough for map->size.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure (the map is left untouched).
+ */
+static map_result_t _robin_resize(map_t *map, size_t new_capacity) {
+    map_robin_slot_t *old_slots = map->robin_slots;
+    size_t old_capacity = map->capacity;
+
+    if (_robin_alloc(map, new_capacity) != MAP_SUCCESS) {
+        return MAP_ALLOCATION_ERROR; // _robin_alloc only commits on success
+    }
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].dist == 0) continue;
+        _robin_place(map, old_slots[i]);
+    }
+
+    free(old_slots);
+    return MAP_SUCCESS;
+}
+
+static map_result_t _robin_init(map_t *map, size_t capacity) {
+    return _robin_alloc(map, _map_round_pow2(capacity, MIN_CAPACITY));
+}
+
+static void _robin_destroy(map_t *map) {
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->robin_slots[i].dist != 0) {
+            _map_free_pair(map, map->robin_slots[i].key, map->robin_slots[i].value);
+        }
+    }
+    free(map->robin_slots);
+}
+
+/**
+ * @brief Finds the slot of a key, or places `key` with a NULL value.
+ * @return Index of the slot, or map->capacity if the table could not grow.
+ */
+static size_t _robin_claim(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    size_t index = _robin_find_index(map, lookup);
+    if (index != map->capacity) {
+        *inserted = 0;
+        return index;
+    }
+
+    if (map->size + 1 > _robin_max_load(map->capacity)) {
+        if (_robin_resize(map, map->capacity * 2) != MAP_SUCCESS) {
+            return map->capacity;
+        }
+    }
+
+    map_robin_slot_t entry = { key, NULL, lookup->hash, lookup->key_len, 0 };
+    index = _robin_place(map, entry);
+    map->size++;
+    *inserted = 1;
+    return index;
+}
+
+static map_result_t _robin_insert(map_t *map, const map_lookup_t *lookup, void *key, void *value) {
+    int inserted;
+    size_t index = _robin_claim(map, lookup, key, &inserted);
+    if (index == map->capacity) {
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    map_robin_slot_t *slot = &map->robin_slots[index];
+    if (inserted) {
+        slot->value = value;
+    } else {
+        _map_replace_pair(map, &slot->key, &slot->value, key, value);
+    }
+    return MAP_SUCCESS;
+}
+
+static void **_robin_entry(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    size_t index = _robin_claim(map, lookup, key, inserted);
+    return (index != map->capacity) ? &map->robin_slots[index].value : NULL;
+}
+
+static void **_robin_find(const map_t *map, const map_lookup_t *lookup) {
+    size_t index = _robin_find_index(map, lookup);
+    return (index != map->capacity) ? &map->robin_slots[index].value : NULL;
+}
+
+static map_result_t _robin_remove(map_t *map, const map_lookup_t *lookup) {
+    size_t index = _robin_find_index(map, lookup);
+    if (index == map->capacity) {
+        return MAP_KEY_NOT_FOUND;
+    }
+
+    _map_free_pair(map, map->robin_slots[index].key, map->robin_slots[index].value);
+
+    // Backward-shift deletion: pull every following displaced entry one slot
+    // closer to home until an empty slot or an entry already at home.
+    size_t mask = map->capacity - 1;
+    size_t next = (index + 1) & mask;
+    while (map->robin_slots[next].dist > 1) {
+        map->robin_slots[index] = map->robin_slots[next];
+        map->robin_slots[index].dist--;
+        index = next;
+        next = (next + 1) & mask;
+    }
+    map->robin_slots[index].dist = 0;
+    map->size--;
+    return MAP_SUCCESS;
+}
+
+static map_result_t _robin_iterate(const map_t *map, map_iter_func_t callback_func, void *user_data) {
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->robin_slots[i].dist == 0) continue;
+        if (callback_func(map->robin_slots[i].key, map->robin_slots[i].value, user_data) != 0) {
+            return MAP_FAILURE; // Callback requested to stop iteration
+        }
+    }
+    return MAP_SUCCESS;
+}
+
+static void _robin_prefetch(const map_t *map, const map_lookup_t *lookup) {
+    _map_prefetch(&map->robin_slots[(size_t)lookup->hash & (map->capacity - 1)]);
+}
+
+static map_result_t _robin_reserve(map_t *map, size_t entries, int shrink) {
+    if (entries < map->size) {
+        entries = map->size;
+    }
+
+    size_t capacity = MIN_CAPACITY;
+    while (_robin_max_load(capacity) < entries) {
+        capacity <<= 1;
+    }
+
+    if (capacity > map->capacity || (shrink && capacity < map->capacity)) {
+        return _robin_resize(map, capacity);
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Starts a cursor just below a slot that is empty or holds an entry at home.
+ * The cursor walks downwards around the table. Backward-shift deletion only moves
+ * entries from higher slots into lower ones and never past such a boundary, so
+ * removing the current entry only moves already visited entries.
+ */
+static void _robin_iter_begin(const map_t *map, map_iter_t *it) {
+    size_t mask = map->capacity - 1;
+    size_t boundary = 0;
+    // The load factor limit guarantees an empty slot, so this terminates
+    while (map->robin_slots[boundary].dist > 1) {
+        boundary++;
+    }
+    it->pos = (boundary - 1) & mask;
+    it->remaining = map->capacity;
+}
+
+static int _robin_iter_next(const map_t *map, map_iter_t *it) {
+    size_t mask = map->capacity - 1;
+    while (it->remaining > 0) {
+        size_t index = it->pos;
+        it->pos = (it->pos - 1) & mask;
+        it->remaining--;
+        const map_robin_slot_t *slot = &map->robin_slots[index];
+        if (slot->dist != 0) {
+            it->key = slot->key;
+            it->key_len = slot->key_len;
+            it->value = slot->value;
+            it->hash = slot->hash;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void _robin_scan_range(const map_t *map, size_t begin, size_t end,
+                              map_accum_func_t callback_func, void *accumulator) {
+    for (size_t i = begin; i < end; ++i) {
+        if (map->robin_slots[i].dist == 0) continue;
+        callback_func(map->robin_slots[i].key, map->robin_slots[i].value, accumulator);
+    }
+}
+
+const map_engine_ops_t map_robin_engine = {
+    _robin_init,
+    _robin_destroy,
+    _robin_insert,
+    _robin_entry,
+    _robin_find,
+    _robin_remove,
+    _robin_iterate,
+    _robin_prefetch,
+    _robin_reserve,
+    _robin_iter_begin,
+    _robin_iter_next,
+    _robin_scan_range,
+};
@@ -0,0 +1,403 @@
+#include "hash_map_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWISS_USE_SSE2 1
+#endif
+
+// Open-addressing engine in the style of Abseil's SwissTable.
+// Entries live inline in a flat slot array. A parallel array holds one control
+// byte per slot: EMPTY, DELETED (tombstone), or the low 7 bits of the key's hash
+// (H2) for a full slot. Lookups load GROUP_WIDTH control bytes at once and only
+// touch slots whose H2 matches, so most misses never dereference a key.
+
+#define GROUP_WIDTH 16          // Control bytes examined per probe step
+#define MIN_CAPACITY GROUP_WIDTH // Capacity is a power of two, at least one group
+#define MAX_LOAD_NUM 7          // Maximum load factor 7/8 ...
+#define MAX_LOAD_DEN 8          // ... counting tombstones as occupied
+
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+
+// Bit i is set when control byte i of a group matched.
+typedef uint32_t group_mask_t;
+
+static inline size_t _swiss_h1(uint64_t hash) { return (size_t)(hash >> 7); }
+static inline uint8_t _swiss_h2(uint64_t hash) { return (uint8_t)(hash & 0x7F); }
+static inline int _swiss_is_full(uint8_t ctrl) { return (ctrl & 0x80) == 0; }
+
+static inline unsigned _swiss_trailing_zeros(group_mask_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(mask);
+#else
+    unsigned n = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Counts leading zeros within the low GROUP_WIDTH bits of the mask.
+static inline unsigned _swiss_leading_zeros(group_mask_t mask) {
+    unsigned n = 0;
+    for (group_mask_t bit = 1u << (GROUP_WIDTH - 1); bit != 0 && (mask & bit) == 0; bit >>= 1) {
+        n++;
+    }
+    return n;
+}
+
+#ifdef SWISS_USE_SSE2
+
+static inline group_mask_t _swiss_match(const uint8_t *group, uint8_t byte) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (group_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)byte), ctrl));
+}
+
+static inline group_mask_t _swiss_match_empty_or_deleted(const uint8_t *group) {
+    // EMPTY and DELETED are the only control bytes with the sign bit set
+    return (group_mask_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+
+#else
+
+static inline group_mask_t _swiss_match(const uint8_t *group, uint8_t byte) {
+    group_mask_t mask = 0;
+    for (unsigned i = 0; i < GROUP_WIDTH; ++i) {
+        mask |= (group_mask_t)(group[i] == byte) << i;
+    }
+    return mask;
+}
+
+static inline group_mask_t _swiss_match_empty_or_deleted(const uint8_t *group) {
+    group_mask_t mask = 0;
+    for (unsigned i = 0; i < GROUP_WIDTH; ++i) {
+        mask |= (group_mask_t)(group[i] >> 7) << i;
+    }
+    return mask;
+}
+
+#endif // SWISS_USE_SSE2
+
+static inline group_mask_t _swiss_match_empty(const uint8_t *group) {
+    return _swiss_match(group, CTRL_EMPTY);
+}
+
+/**
+ * @brief Writes a control byte, keeping the cloned bytes past the end in sync.
+ * The first GROUP_WIDTH control bytes are mirrored after the last slot so that a
+ * group load starting near the end of the table wraps around without branching.
+ */
+static inline void _swiss_set_ctrl(map_t *map, size_t index, uint8_t ctrl) {
+    map->ctrl[index] = ctrl;
+    if (index < GROUP_WIDTH) {
+        map->ctrl[map->capacity + index] = ctrl;
+    }
+}
+
+static inline size_t _swiss_max_load(size_t capacity) {
+    return capacity / MAX_LOAD_DEN * MAX_LOAD_NUM;
+}
+
+/**
+ * @brief Allocates empty control bytes and slots for the given capacity.
+ * @param map Pointer to the map. Its storage fields are overwritten.
+ * @param capacity Number of slots, a power of two.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure.
+ */
+static map_result_t _swiss_alloc(map_t *map, size_t capacity) {
+    uint8_t *ctrl = (uint8_t *)malloc(capacity + GROUP_WIDTH);
+    map_swiss_slot_t *slots = (map_swiss_slot_t *)malloc(capacity * sizeof(map_swiss_slot_t));
+    if (ctrl == NULL || slots == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate swiss table storage.\n");
+        free(ctrl);
+        free(slots);
+        return MAP_ALLOCATION_ERROR;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+
+    map->ctrl = ctrl;
+    map->slots = slots;
+    map->capacity = capacity;
+    map->growth_left = _swiss_max_load(capacity);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Finds the first EMPTY or DELETED slot on the probe sequence of a hash.
+ * The table always keeps at least one EMPTY slot, so this terminates.
+ * @param map Pointer to the map.
+ * @param hash Hash of the key.
+ * @return Index of the slot.
+ */
+static size_t _swiss_find_insert_slot(const map_t *map, uint64_t hash) {
+    size_t mask = map->capacity - 1;
+    size_t pos = _swiss_h1(hash) & mask;
+    size_t step = 0;
+
+    for (;;) {
+        group_mask_t free_slots = _swiss_match_empty_or_deleted(map->ctrl + pos);
+        if (free_slots != 0) {
+            return (pos + _swiss_trailing_zeros(free_slots)) & mask;
+        }
+        step += GROUP_WIDTH;
+        pos = (pos + step) & mask; // Triangular probing visits every group once
+    }
+}
+
+/**
+ * @brief Finds the slot holding a key.
+ * @param map Pointer to the map.
+ * @param lookup The hashed key.
+ * @return Index of the slot, or map->capacity if the key is not present.
+ */
+static size_t _swiss_find_index(const map_t *map, const map_lookup_t *lookup) {
+    size_t mask = map->capacity - 1;
+    size_t pos = _swiss_h1(lookup->hash) & mask;
+    uint8_t h2 = _swiss_h2(lookup->hash);
+    size_t step = 0;
+
+    for (;;) {
+        const uint8_t *group = map->ctrl + pos;
+        group_mask_t candidates = _swiss_match(group, h2);
+        while (candidates != 0) {
+            size_t index = (pos + _swiss_trailing_zeros(candidates)) & mask;
+            if (_map_key_equals(map, map->slots[index].hash, map->slots[index].key,
+                                map->slots[index].key_len, lookup)) {
+                return index;
+            }
+            candidates &= candidates - 1;
+        }
+        // An EMPTY byte ends the probe: the key would have been placed there
+        if (_swiss_match_empty(group) != 0) {
+            return map->capacity;
+        }
+        step += GROUP_WIDTH;
+        pos = (pos + step) & mask;
+        if (step >= map->capacity) {
+            return map->capacity; // Every group visited
+        }
+    }
+}
+
+/**
+ * @brief Moves every entry into freshly allocated storage of the given capacity.
+ * Tombstones are dropped in the process.
+ * @param map Pointer to the map.
+ * @param new_capacity Number of slots, a power of two no smaller than needed for map->size.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on failure (the map is left untouched).
+ */
+static map_result_t _swiss_resize(map_t *map, size_t new_capacity) {
+    uint8_t *old_ctrl = map->ctrl;
+    map_swiss_slot_t *old_slots = map->slots;
+    size_t old_capacity = map->capacity;
+
+    if (_swiss_alloc(map, new_capacity) != MAP_SUCCESS) {
+        return MAP_ALLOCATION_ERROR; // _swiss_alloc only commits on success
+    }
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (!_swiss_is_full(old_ctrl[i])) continue;
+
+        uint64_t hash = old_slots[i].hash;
+        size_t index = _swiss_find_insert_slot(map, hash);
+        _swiss_set_ctrl(map, index, _swiss_h2(hash));
+        map->slots[index] = old_slots[i];
+    }
+    map->growth_left -= map->size;
+
+    free(old_ctrl);
+    free(old_slots);
+    return MAP_SUCCESS;
+}
+
+static map_result_t _swiss_init(map_t *map, size_t capacity) {
+    return _swiss_alloc(map, _map_round_pow2(capacity, MIN_CAPACITY));
+}
+
+static void _swiss_destroy(map_t *map) {
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (_swiss_is_full(map->ctrl[i])) {
+            _map_free_pair(map, map->slots[i].key, map->slots[i].value);
+        }
+    }
+    free(map->ctrl);
+    free(map->slots);
+}
+
+/**
+ * @brief Finds the slot of a key, or fills a slot with `key` and a NULL value.
+ * @return Index of the slot, or map->capacity if the table could not grow.
+ */
+static size_t _swiss_claim(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    size_t index = _swiss_find_index(map, lookup);
+    if (index != map->capacity) {
+        *inserted = 0;
+        return index;
+    }
+
+    index = _swiss_find_insert_slot(map, lookup->hash);
+    if (map->growth_left == 0 && map->ctrl[index] == CTRL_EMPTY) {
+        // Out of EMPTY slots. If tombstones make up a large share of the table,
+        // rehashing in place reclaims them; otherwise the table really is full.
+        size_t new_capacity = map->capacity;
+        if (map->size + 1 > _swiss_max_load(map->capacity) / 2) {
+            new_capacity *= 2;
+        }
+        if (_swiss_resize(map, new_capacity) != MAP_SUCCESS) {
+            return map->capacity;
+        }
+        index = _swiss_find_insert_slot(map, lookup->hash);
+    }
+
+    if (map->ctrl[index] == CTRL_EMPTY) {
+        map->growth_left--; // Reusing a tombstone does not consume growth
+    }
+    _swiss_set_ctrl(map, index, _swiss_h2(lookup->hash));
+    map->slots[index].key = key;
+    map->slots[index].value = NULL;
+    map->slots[index].hash = lookup->hash;
+    map->slots[index].key_len = lookup->key_len;
+    map->size++;
+    *inserted = 1;
+    return index;
+}
+
+static map_result_t _swiss_insert(map_t *map, const map_lookup_t *lookup, void *key, void *value) {
+    int inserted;
+    size_t index = _swiss_claim(map, lookup, key, &inserted);
+    if (index == map->capacity) {
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    map_swiss_slot_t *slot = &map->slots[index];
+    if (inserted) {
+        slot->value = value;
+    } else {
+        _map_replace_pair(map, &slot->key, &slot->value, key, value);
+    }
+    return MAP_SUCCESS;
+}
+
+static void **_swiss_entry(map_t *map, const map_lookup_t *lookup, void *key, int *inserted) {
+    size_t index = _swiss_claim(map, lookup, key, inserted);
+    return (index != map->capacity) ? &map->slots[index].value : NULL;
+}
+
+static void **_swiss_find(const map_t *map, const map_lookup_t *lookup) {
+    size_t index = _swiss_find_index(map, lookup);
+    return (index != map->capacity) ? &map->slots[index].value : NULL;
+}
+
+static map_result_t _swiss_remove(map_t *map, const map_lookup_t *lookup) {
+    size_t index = _swiss_find_index(map, lookup);
+    if (index == map->capacity) {
+        return MAP_KEY_NOT_FOUND;
+    }
+
+    _map_free_pair(map, map->slots[index].key, map->slots[index].value);
+
+    // If the run of non-EMPTY bytes around the slot is shorter than a group, no
+    // probe window can have seen it as full, so no probe ever continued past it
+    // and the slot can go straight back to EMPTY. Otherwise leave a tombstone.
+    size_t mask = map->capacity - 1;
+    group_mask_t empty_after = _swiss_match_empty(map->ctrl + index);
+    group_mask_t empty_before = _swiss_match_empty(map->ctrl + ((index - GROUP_WIDTH) & mask));
+    int was_never_full = empty_before != 0 && empty_after != 0 &&
+        _swiss_trailing_zeros(empty_after) + _swiss_leading_zeros(empty_before) < GROUP_WIDTH;
+
+    if (was_never_full) {
+        _swiss_set_ctrl(map, index, CTRL_EMPTY);
+        map->growth_left++;
+    } else {
+        _swiss_set_ctrl(map, index, CTRL_DELETED);
+    }
+    map->size--;
+    return MAP_SUCCESS;
+}
+
+static map_result_t _swiss_iterate(const map_t *map, map_iter_func_t callback_func, void *user_data) {
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (!_swiss_is_full(map->ctrl[i])) continue;
+        if (callback_func(map->slots[i].key, map->slots[i].value, user_data) != 0) {
+            return MAP_FAILURE; // Callback requested to stop iteration
+        }
+    }
+    return MAP_SUCCESS;
+}
+
+static void _swiss_prefetch(const map_t *map, const map_lookup_t *lookup) {
+    size_t pos = _swiss_h1(lookup->hash) & (map->capacity - 1);
+    _map_prefetch(map->ctrl + pos);
+    _map_prefetch(&map->slots[pos]);
+}
+
+static map_result_t _swiss_reserve(map_t *map, size_t entries, int shrink) {
+    if (entries < map->size) {
+        entries = map->size;
+    }
+
+    size_t capacity = MIN_CAPACITY;
+    while (_swiss_max_load(capacity) < entries) {
+        capacity <<= 1;
+    }
+
+    if (capacity > map->capacity || (shrink && capacity < map->capacity)) {
+        return _swiss_resize(map, capacity);
+    }
+    return MAP_SUCCESS;
+}
+
+static void _swiss_iter_begin(const map_t *map, map_iter_t *it) {
+    (void)map;
+    it->pos = 0;
+}
+
+static int _swiss_iter_next(const map_t *map, map_iter_t *it) {
+    // Removal only rewrites control bytes, so a forward scan never skips or repeats
+    while (it->pos < map->capacity) {
+        // Skip a whole group when it holds no full slot
+        if (it->pos + GROUP_WIDTH <= map->capacity &&
+            _swiss_match_empty_or_deleted(map->ctrl + it->pos) == (1u << GROUP_WIDTH) - 1) {
+            it->pos += GROUP_WIDTH;
+            continue;
+        }
+        size_t index = it->pos++;
+        if (_swiss_is_full(map->ctrl[index])) {
+            it->key = map->slots[index].key;
+            it->key_len = map->slots[index].key_len;
+            it->value = map->slots[index].value;
+            it->hash = map->slots[index].hash;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void _swiss_scan_range(const map_t *map, size_t begin, size_t end,
+                              map_accum_func_t callback_func, void *accumulator) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!_swiss_is_full(map->ctrl[i])) continue;
+        callback_func(map->slots[i].key, map->slots[i].value, accumulator);
+    }
+}
+
+const map_engine_ops_t map_swiss_engine = {
+    _swiss_init,
+    _swiss_destroy,
+    _swiss_insert,
+    _swiss_entry,
+    _swiss_find,
+    _swiss_remove,
+    _swiss_iterate,
+    _swiss_prefetch,
+    _swiss_reserve,
+    _swiss_iter_begin,
+    _swiss_iter_next,
+    _swiss_scan_range,
+};
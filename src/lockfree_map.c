@@ -0,0 +1,448 @@
+#include "lockfree_map.h"
+#include "cache_line.h"
+#include "epoch.h"
+#include "hash_map_internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LFMAP_INITIAL_CAPACITY 64   // Default initial number of buckets
+#define LFMAP_DEFAULT_STRIPES 64    // Default number of writer lock stripes
+#define LFMAP_LOAD_FACTOR_THRESHOLD 0.75 // Grow when a stripe's share of buckets exceeds this load
+
+// Node of a bucket chain. Only next changes after the node is published.
+typedef struct lfmap_node_t {
+    void *key;
+    void *value;
+    uint64_t hash;             // Cached mixed hash of the key
+    _Atomic(struct lfmap_node_t *) next;
+    epoch_entry_t retire;      // Reclamation hook, used once the node is unlinked
+} lfmap_node_t;
+
+// Bucket array. A resize publishes a new table and retires the old one whole.
+typedef struct lfmap_table_t {
+    size_t capacity;           // Number of buckets, a power of two and a multiple of stripe_count
+    epoch_entry_t retire;
+    _Atomic(lfmap_node_t *) buckets[];
+} lfmap_table_t;
+
+// Writer lock stripe, same layout rules as cmap_t's stripes.
+typedef union {
+    struct {
+        pthread_mutex_t lock;
+        atomic_size_t size;    // Entries in this stripe's buckets
+    } s;
+    _Alignas(CACHE_LINE_SIZE) char pad[CACHE_LINE_PAD];
+} lfmap_stripe_t;
+
+struct lfmap_t {
+    _Atomic(lfmap_table_t *) table;
+    lfmap_stripe_t *stripes;
+    size_t stripe_count;       // Number of stripes, a power of two
+    hash_func_t hash_func;     // Function to hash keys
+    compare_func_t compare_func; // Function to compare keys
+    free_func_t key_free_func; // Optional: Function to free key memory
+    free_func_t value_free_func; // Optional: Function to free value memory
+};
+
+static inline uint64_t _lfmap_hash(const lfmap_t *map, const void *key) {
+    return _map_mix64((uint64_t)map->hash_func(key));
+}
+
+static inline lfmap_stripe_t *_lfmap_stripe(const lfmap_t *map, uint64_t hash) {
+    return &map->stripes[(size_t)hash & (map->stripe_count - 1)];
+}
+
+static inline lfmap_node_t *_lfmap_node_of(epoch_entry_t *entry) {
+    return (lfmap_node_t *)((char *)entry - offsetof(lfmap_node_t, retire));
+}
+
+static void _lfmap_free_pair(const lfmap_t *map, void *key, void *value) {
+    if (map->key_free_func && key) {
+        map->key_free_func(key);
+    }
+    if (map->value_free_func && value) {
+        map->value_free_func(value);
+    }
+}
+
+// Reclamation callbacks; entry->context is the map.
+
+static void _lfmap_free_node(epoch_entry_t *entry) {
+    lfmap_node_t *node = _lfmap_node_of(entry);
+    _lfmap_free_pair((const lfmap_t *)entry->context, node->key, node->value);
+    free(node);
+}
+
+static void _lfmap_free_node_value(epoch_entry_t *entry) {
+    lfmap_node_t *node = _lfmap_node_of(entry);
+    _lfmap_free_pair((const lfmap_t *)entry->context, NULL, node->value);
+    free(node);
+}
+
+static void _lfmap_free_table(epoch_entry_t *entry) {
+    lfmap_table_t *table = (lfmap_table_t *)((char *)entry - offsetof(lfmap_table_t, retire));
+    // The nodes were copied into the new table, which now owns their keys and values
+    for (size_t i = 0; i < table->capacity; ++i) {
+        lfmap_node_t *current = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+        while (current != NULL) {
+            lfmap_node_t *next_node = atomic_load_explicit(&current->next, memory_order_relaxed);
+            free(current);
+            current = next_node;
+        }
+    }
+    free(table);
+}
+
+static lfmap_table_t *_lfmap_table_alloc(size_t capacity) {
+    lfmap_table_t *table = (lfmap_table_t *)calloc(1, sizeof(lfmap_table_t) + capacity * sizeof(table->buckets[0]));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->capacity = capacity;
+    return table;
+}
+
+/**
+ * @brief Finds the link that points at a key's node. Caller holds the key's stripe lock.
+ * @return Address of the link to the node, or NULL if the key is not found.
+ */
+static _Atomic(lfmap_node_t *) *_lfmap_find_link(const lfmap_t *map, lfmap_table_t *table,
+                                                 const void *key, uint64_t hash) {
+    _Atomic(lfmap_node_t *) *link = &table->buckets[(size_t)hash & (table->capacity - 1)];
+    lfmap_node_t *current;
+    while ((current = atomic_load_explicit(link, memory_order_relaxed)) != NULL) {
+        if (current->hash == hash && map->compare_func(current->key, key) == 0) {
+            return link;
+        }
+        link = &current->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Doubles the bucket array, unless another thread already grew it.
+ * Readers keep walking the old table while the new one is built. Nodes are
+ * copied rather than relinked, so an old chain never changes under a reader;
+ * the old table and its nodes are retired after the new table is published.
+ * @param map Pointer to the map.
+ * @param seen_capacity Capacity observed by the caller when it decided to grow.
+ */
+static void _lfmap_grow(lfmap_t *map, size_t seen_capacity) {
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_mutex_lock(&map->stripes[i].s.lock);
+    }
+
+    lfmap_table_t *old_table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    lfmap_table_t *new_table = NULL;
+    if (old_table->capacity == seen_capacity) {
+        new_table = _lfmap_table_alloc(old_table->capacity * 2);
+    }
+
+    int failed = 0;
+    if (new_table != NULL) {
+        size_t mask = new_table->capacity - 1;
+        for (size_t i = 0; i < old_table->capacity && !failed; ++i) {
+            lfmap_node_t *current = atomic_load_explicit(&old_table->buckets[i], memory_order_relaxed);
+            for (; current != NULL; current = atomic_load_explicit(&current->next, memory_order_relaxed)) {
+                lfmap_node_t *copy = (lfmap_node_t *)malloc(sizeof(lfmap_node_t));
+                if (copy == NULL) {
+                    failed = 1;
+                    break;
+                }
+                _Atomic(lfmap_node_t *) *bucket = &new_table->buckets[(size_t)current->hash & mask];
+                copy->key = current->key;
+                copy->value = current->value;
+                copy->hash = current->hash;
+                atomic_init(&copy->next, atomic_load_explicit(bucket, memory_order_relaxed));
+                atomic_init(bucket, copy);
+            }
+        }
+        if (failed) {
+            // Keep running at a higher load; the next insert will try again
+            fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate nodes for resize.\n");
+            _lfmap_free_table(&new_table->retire);
+        } else {
+            atomic_store_explicit(&map->table, new_table, memory_order_release);
+            epoch_retire(&old_table->retire, _lfmap_free_table, map);
+        }
+    } else if (old_table->capacity == seen_capacity) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate new buckets for resize.\n");
+    }
+
+    for (size_t i = map->stripe_count; i > 0; --i) {
+        pthread_mutex_unlock(&map->stripes[i - 1].s.lock);
+    }
+}
+
+/**
+ * @brief Creates a read-optimized concurrent map.
+ * @param initial_capacity The initial number of buckets. If 0, uses LFMAP_INITIAL_CAPACITY.
+ * @param stripes Number of writer lock stripes, rounded up to a power of two. If 0, uses LFMAP_DEFAULT_STRIPES.
+ * @param hash_func Function to hash keys. MUST NOT be NULL.
+ * @param compare_func Function to compare keys. MUST NOT be NULL.
+ * @param key_free_func Optional: Function to free key memory. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory. Can be NULL.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+lfmap_t *lfmap_create(
+    size_t initial_capacity,
+    size_t stripes,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func) {
+    if (hash_func == NULL || compare_func == NULL) {
+        fprintf(stderr, "MAP_FAILURE: Hash function and compare function cannot be NULL.\n");
+        return NULL;
+    }
+
+    lfmap_t *map = (lfmap_t *)calloc(1, sizeof(lfmap_t));
+    if (map == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map structure.\n");
+        return NULL;
+    }
+
+    map->stripe_count = _map_round_pow2((stripes > 0) ? stripes : LFMAP_DEFAULT_STRIPES, 1);
+    size_t capacity = _map_round_pow2((initial_capacity > 0) ? initial_capacity : LFMAP_INITIAL_CAPACITY,
+                                      map->stripe_count);
+    map->hash_func = hash_func;
+    map->compare_func = compare_func;
+    map->key_free_func = key_free_func;
+    map->value_free_func = value_free_func;
+
+    lfmap_table_t *table = _lfmap_table_alloc(capacity);
+    map->stripes = (lfmap_stripe_t *)_cache_line_calloc(map->stripe_count, sizeof(lfmap_stripe_t));
+    if (table == NULL || map->stripes == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map buckets.\n");
+        free(table);
+        free(map->stripes);
+        free(map);
+        return NULL;
+    }
+    atomic_init(&map->table, table);
+
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_mutex_init(&map->stripes[i].s.lock, NULL);
+        atomic_init(&map->stripes[i].s.size, 0);
+    }
+    return map;
+}
+
+/**
+ * @brief Destroys the map and frees all associated memory.
+ * @param map Pointer to the map to destroy.
+ */
+void lfmap_destroy(lfmap_t *map) {
+    if (map == NULL) return;
+
+    // Deferred frees still reference the map's free functions
+    epoch_barrier();
+
+    lfmap_table_t *table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    for (size_t i = 0; i < table->capacity; ++i) {
+        lfmap_node_t *current = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+        while (current != NULL) {
+            lfmap_node_t *next_node = atomic_load_explicit(&current->next, memory_order_relaxed);
+            _lfmap_free_pair(map, current->key, current->value);
+            free(current);
+            current = next_node;
+        }
+    }
+    free(table);
+
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        pthread_mutex_destroy(&map->stripes[i].s.lock);
+    }
+    free(map->stripes);
+    free(map);
+}
+
+/**
+ * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t lfmap_insert(lfmap_t *map, void *key, void *value) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    lfmap_node_t *node = (lfmap_node_t *)malloc(sizeof(lfmap_node_t));
+    if (node == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map node.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+    uint64_t hash = _lfmap_hash(map, key);
+    node->key = key;
+    node->value = value;
+    node->hash = hash;
+
+    lfmap_stripe_t *stripe = _lfmap_stripe(map, hash);
+    pthread_mutex_lock(&stripe->s.lock);
+
+    // The table cannot be swapped while we hold a stripe lock
+    lfmap_table_t *table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    _Atomic(lfmap_node_t *) *link = _lfmap_find_link(map, table, key, hash);
+    if (link != NULL) {
+        // Replace the node so readers see either the old pair or the new one, never a mix
+        lfmap_node_t *old_node = atomic_load_explicit(link, memory_order_relaxed);
+        atomic_init(&node->next, atomic_load_explicit(&old_node->next, memory_order_relaxed));
+        atomic_store_explicit(link, node, memory_order_release);
+        pthread_mutex_unlock(&stripe->s.lock);
+
+        // Same replacement rules as map_insert
+        epoch_retire(&old_node->retire,
+                     (old_node->key != key) ? _lfmap_free_node : _lfmap_free_node_value, map);
+        return MAP_SUCCESS;
+    }
+
+    _Atomic(lfmap_node_t *) *bucket = &table->buckets[(size_t)hash & (table->capacity - 1)];
+    atomic_init(&node->next, atomic_load_explicit(bucket, memory_order_relaxed));
+    atomic_store_explicit(bucket, node, memory_order_release);
+
+    // Each stripe owns capacity / stripe_count buckets; judge the load on that share
+    size_t stripe_size = atomic_load_explicit(&stripe->s.size, memory_order_relaxed) + 1;
+    atomic_store_explicit(&stripe->s.size, stripe_size, memory_order_relaxed);
+    size_t capacity = table->capacity;
+    int needs_grow = (double)stripe_size / (capacity / map->stripe_count) > LFMAP_LOAD_FACTOR_THRESHOLD;
+    pthread_mutex_unlock(&stripe->s.lock);
+
+    if (needs_grow) {
+        _lfmap_grow(map, capacity);
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Finds a key's node. Caller is inside an epoch critical section.
+ * @return The node, or NULL if the key is not found.
+ */
+static lfmap_node_t *_lfmap_find(const lfmap_t *map, const void *key) {
+    uint64_t hash = _lfmap_hash(map, key);
+    lfmap_table_t *table = atomic_load_explicit(&map->table, memory_order_acquire);
+    lfmap_node_t *current = atomic_load_explicit(&table->buckets[(size_t)hash & (table->capacity - 1)],
+                                                 memory_order_acquire);
+    for (; current != NULL; current = atomic_load_explicit(&current->next, memory_order_acquire)) {
+        if (current->hash == hash && map->compare_func(current->key, key) == 0) {
+            return current;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *lfmap_get(lfmap_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    epoch_enter();
+    lfmap_node_t *node = _lfmap_find(map, key);
+    void *value = (node != NULL) ? node->value : NULL;
+    epoch_exit();
+    return value;
+}
+
+/**
+ * @brief Checks if a key exists in the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int lfmap_contains(lfmap_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return 0;
+    }
+
+    epoch_enter();
+    int found = _lfmap_find(map, key) != NULL;
+    epoch_exit();
+    return found;
+}
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t lfmap_delete(lfmap_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    uint64_t hash = _lfmap_hash(map, key);
+    lfmap_stripe_t *stripe = _lfmap_stripe(map, hash);
+    pthread_mutex_lock(&stripe->s.lock);
+
+    lfmap_table_t *table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    _Atomic(lfmap_node_t *) *link = _lfmap_find_link(map, table, key, hash);
+    if (link == NULL) {
+        pthread_mutex_unlock(&stripe->s.lock);
+        return MAP_KEY_NOT_FOUND;
+    }
+    // A reader standing on the node can still follow its next pointer
+    lfmap_node_t *current = atomic_load_explicit(link, memory_order_relaxed);
+    atomic_store_explicit(link, atomic_load_explicit(&current->next, memory_order_relaxed), memory_order_release);
+    atomic_store_explicit(&stripe->s.size,
+                          atomic_load_explicit(&stripe->s.size, memory_order_relaxed) - 1,
+                          memory_order_relaxed);
+    pthread_mutex_unlock(&stripe->s.lock);
+
+    epoch_retire(&current->retire, _lfmap_free_node, map);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Returns the number of key-value pairs in the map.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t lfmap_size(lfmap_t *map) {
+    if (map == NULL) return 0;
+
+    size_t size = 0;
+    for (size_t i = 0; i < map->stripe_count; ++i) {
+        size += atomic_load_explicit(&map->stripes[i].s.size, memory_order_relaxed);
+    }
+    return size;
+}
+
+/**
+ * @brief Iterates over the key-value pairs without taking any lock.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t lfmap_iterate(lfmap_t *map, map_iter_func_t callback_func, void *user_data) {
+    if (map == NULL || callback_func == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_result_t res = MAP_SUCCESS;
+    epoch_enter();
+    // A concurrent resize does not disturb us: we keep walking the table we loaded
+    lfmap_table_t *table = atomic_load_explicit(&map->table, memory_order_acquire);
+    for (size_t i = 0; i < table->capacity && res == MAP_SUCCESS; ++i) {
+        lfmap_node_t *current = atomic_load_explicit(&table->buckets[i], memory_order_acquire);
+        for (; current != NULL; current = atomic_load_explicit(&current->next, memory_order_acquire)) {
+            if (callback_func(current->key, current->value, user_data) != 0) {
+                res = MAP_FAILURE; // Callback requested to stop iteration
+                break;
+            }
+        }
+    }
+    epoch_exit();
+    return res;
+}
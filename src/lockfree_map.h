@@ -0,0 +1,100 @@
+#ifndef LOCKFREE_MAP_H
+#define LOCKFREE_MAP_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Read-optimized thread-safe hash map.
+// Lookups take no locks and write no shared memory: they walk the buckets with
+// atomic loads inside an epoch critical section (see epoch.h). Writers serialize
+// per lock stripe and publish with release stores; nodes are never modified in
+// place, so an update swaps in a new node. Unlinked nodes, replaced values and
+// old bucket arrays are freed through epoch-based reclamation, so a lookup never
+// blocks, not even while the table is being resized.
+// Uses the same hash/compare/free hooks as map_t.
+typedef struct lfmap_t lfmap_t;
+
+/**
+ * @brief Creates a read-optimized concurrent map.
+ * @param initial_capacity The initial number of buckets. If 0, uses a default.
+ * @param stripes Number of writer lock stripes, rounded up to a power of two. If 0, uses a default.
+ * @param hash_func Function to hash keys. MUST NOT be NULL.
+ * @param compare_func Function to compare keys. MUST NOT be NULL.
+ * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+lfmap_t *lfmap_create(
+    size_t initial_capacity,
+    size_t stripes,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func);
+
+/**
+ * @brief Destroys the map. No other thread may be using it, and the calling
+ * thread must not be inside an epoch critical section.
+ * @param map Pointer to the map to destroy.
+ */
+void lfmap_destroy(lfmap_t *map);
+
+/**
+ * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+ * A replaced key or value is freed once no reader can still see it.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t lfmap_insert(lfmap_t *map, void *key, void *value);
+
+/**
+ * @brief Retrieves the value associated with a key without taking any lock.
+ * The value stays valid until the calling thread leaves its epoch critical
+ * section. Wrap the call and every use of the result in epoch_enter() /
+ * epoch_exit() if other threads may update or delete the key.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *lfmap_get(lfmap_t *map, const void *key);
+
+/**
+ * @brief Checks if a key exists in the map without taking any lock.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int lfmap_contains(lfmap_t *map, const void *key);
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * The key and value are freed once no reader can still see them.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t lfmap_delete(lfmap_t *map, const void *key);
+
+/**
+ * @brief Returns the number of key-value pairs in the map.
+ * Exact when no writer is active; otherwise a snapshot that may be slightly stale.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t lfmap_size(lfmap_t *map);
+
+/**
+ * @brief Iterates over the key-value pairs without taking any lock.
+ * Writers are not blocked: entries inserted or deleted concurrently may or may
+ * not be visited, but every entry present throughout is visited exactly once.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t lfmap_iterate(lfmap_t *map, map_iter_func_t callback_func, void *user_data);
+
+#endif // LOCKFREE_MAP_H
@@ -0,0 +1,314 @@
+#include "lru_cache.h"
+#include "hash_map_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LRU_RESERVE_MAX 65536      // Entry-counted caches pre-size their map for at most this many entries
+
+struct lru_cache_t {
+    map_t *map;                // Chained map; its entry list runs from least to most recently used
+    size_t capacity;           // Charge the cache may hold
+    size_t charge;             // Summed charge of the cached entries
+    lru_charge_func_t charge_func; // Optional: Weighs entries; NULL charges 1 each
+};
+
+/**
+ * @brief Charge of one entry.
+ */
+static inline size_t _lru_charge(const lru_cache_t *cache, const void *key, const void *value) {
+    return (cache->charge_func != NULL) ? cache->charge_func(key, value) : 1;
+}
+
+/**
+ * @brief Evicts least recently used entries until the cache fits its capacity.
+ * The most recently used entry is never evicted.
+ * @param cache Pointer to the cache.
+ */
+static void _lru_evict(lru_cache_t *cache) {
+    map_t *map = cache->map;
+    while (cache->charge > cache->capacity && map->list_head != map->list_tail) {
+        map_node_t *oldest = map->list_head;
+        map_lookup_t lookup = { oldest->key, oldest->key_len, oldest->hash };
+        cache->charge -= _lru_charge(cache, oldest->key, oldest->value);
+        _map_remove(map, &lookup);
+    }
+}
+
+/**
+ * @brief Creates an LRU cache.
+ * @param capacity Total charge the cache holds before it evicts.
+ * @param charge_func Optional: Weighs each entry. NULL charges every entry 1.
+ * @param hash_func Function to hash keys.
+ * @param compare_func Function to compare keys.
+ * @param key_free_func Optional: Function to free key memory. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory. Can be NULL.
+ * @param options Optional: Options of the underlying map. NULL selects the defaults.
+ * @return A pointer to the newly created cache, or NULL on error.
+ */
+lru_cache_t *lru_cache_create(
+    size_t capacity,
+    lru_charge_func_t charge_func,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options) {
+    map_options_t map_options = {0};
+    if (options != NULL) {
+        map_options = *options;
+    }
+    if (map_options.copy_keys || map_options.bloom_bits_per_key > 0) {
+        fprintf(stderr, "MAP_FAILURE: LRU caches cannot use copy_keys or a Bloom filter; both keep evicted keys.\n");
+        return NULL;
+    }
+    if (capacity == 0) {
+        fprintf(stderr, "MAP_FAILURE: LRU cache capacity cannot be 0.\n");
+        return NULL;
+    }
+    map_options.engine = MAP_ENGINE_CHAINED; // The chained entry list is the recency list
+
+    lru_cache_t *cache = (lru_cache_t *)calloc(1, sizeof(lru_cache_t));
+    if (cache == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate cache structure.\n");
+        return NULL;
+    }
+
+    cache->map = map_create_with_options(0, hash_func, compare_func, key_free_func, value_free_func, &map_options);
+    if (cache->map == NULL) {
+        free(cache);
+        return NULL;
+    }
+    if (charge_func == NULL) {
+        // The entry count is known up front, so the map need not grow while the cache fills
+        map_reserve(cache->map, (capacity < LRU_RESERVE_MAX) ? capacity : LRU_RESERVE_MAX);
+    }
+    cache->capacity = capacity;
+    cache->charge_func = charge_func;
+    return cache;
+}
+
+/**
+ * @brief Destroys the cache, freeing every entry.
+ * @param cache Pointer to the cache to destroy.
+ */
+void lru_cache_destroy(lru_cache_t *cache) {
+    if (cache == NULL) return;
+
+    map_destroy(cache->map);
+    free(cache);
+}
+
+/**
+ * @brief Inserts or replaces a prepared key, making it the most recently used entry.
+ * @param cache Pointer to the cache.
+ * @param lookup The hashed key.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure.
+ */
+static map_result_t _lru_put(lru_cache_t *cache, const map_lookup_t *lookup, void *key, void *value) {
+    map_t *map = cache->map;
+    int inserted;
+    void **stored = _map_entry_lookup(map, lookup, key, &inserted);
+    if (stored == NULL) {
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    map_node_t *node = (map_node_t *)((char *)stored - offsetof(map_node_t, value));
+    if (inserted) {
+        node->value = value;
+    } else {
+        cache->charge -= _lru_charge(cache, node->key, node->value);
+        _map_replace_pair(map, &node->key, &node->value, key, value);
+        _map_chained_move_to_back(map, stored);
+    }
+    cache->charge += _lru_charge(cache, node->key, node->value);
+
+    _lru_evict(cache);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Marks a found entry as most recently used.
+ * @param cache Pointer to the cache.
+ * @param value Address of the entry's value, or NULL if the key was not found.
+ * @return The entry's value, or NULL if the key was not found.
+ */
+static void *_lru_hit(lru_cache_t *cache, void **value) {
+    if (value == NULL) {
+        return NULL;
+    }
+    _map_chained_move_to_back(cache->map, value);
+    return *value;
+}
+
+/**
+ * @brief Removes a prepared key, freeing its key and value through the free functions.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found.
+ */
+static map_result_t _lru_delete(lru_cache_t *cache, const map_lookup_t *lookup) {
+    void **value = _map_find_lookup(cache->map, lookup);
+    if (value == NULL) {
+        return MAP_KEY_NOT_FOUND;
+    }
+
+    // Charge the entry off while its key and value still exist
+    map_node_t *node = (map_node_t *)((char *)value - offsetof(map_node_t, value));
+    cache->charge -= _lru_charge(cache, node->key, node->value);
+    return _map_remove(cache->map, lookup);
+}
+
+/**
+ * @brief Inserts or replaces an entry, making it the most recently used one.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_put(lru_cache_t *cache, void *key, void *value) {
+    if (cache == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, _map_default_key_len(cache->map, key), &lookup);
+    return _lru_put(cache, &lookup, key, value);
+}
+
+/**
+ * @brief Inserts or replaces an entry with a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_put_n(lru_cache_t *cache, void *key, size_t key_len, void *value) {
+    if (cache == NULL || key == NULL || cache->map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, key_len, &lookup);
+    return _lru_put(cache, &lookup, key, value);
+}
+
+/**
+ * @brief Retrieves a value and marks its entry as most recently used.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+void *lru_cache_get(lru_cache_t *cache, const void *key) {
+    if (cache == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, _map_default_key_len(cache->map, key), &lookup);
+    return _lru_hit(cache, _map_find_lookup(cache->map, &lookup));
+}
+
+/**
+ * @brief Like lru_cache_get, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not cached or on invalid input.
+ */
+void *lru_cache_get_n(lru_cache_t *cache, const void *key, size_t key_len) {
+    if (cache == NULL || key == NULL || cache->map->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, key_len, &lookup);
+    return _lru_hit(cache, _map_find_lookup(cache->map, &lookup));
+}
+
+/**
+ * @brief Retrieves a value without changing the recency order.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+void *lru_cache_peek(const lru_cache_t *cache, const void *key) {
+    if (cache == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, _map_default_key_len(cache->map, key), &lookup);
+    void **value = _map_find_lookup(cache->map, &lookup);
+    return (value != NULL) ? *value : NULL;
+}
+
+/**
+ * @brief Like lru_cache_peek, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not cached or on invalid input.
+ */
+void *lru_cache_peek_n(const lru_cache_t *cache, const void *key, size_t key_len) {
+    if (cache == NULL || key == NULL || cache->map->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, key_len, &lookup);
+    void **value = _map_find_lookup(cache->map, &lookup);
+    return (value != NULL) ? *value : NULL;
+}
+
+/**
+ * @brief Removes an entry, freeing its key and value through the free functions.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_delete(lru_cache_t *cache, const void *key) {
+    if (cache == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, _map_default_key_len(cache->map, key), &lookup);
+    return _lru_delete(cache, &lookup);
+}
+
+/**
+ * @brief Like lru_cache_delete, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_delete_n(lru_cache_t *cache, const void *key, size_t key_len) {
+    if (cache == NULL || key == NULL || cache->map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(cache->map, key, key_len, &lookup);
+    return _lru_delete(cache, &lookup);
+}
+
+/**
+ * @brief Returns the number of cached entries.
+ * @param cache Pointer to the cache.
+ * @return The number of entries.
+ */
+size_t lru_cache_size(const lru_cache_t *cache) {
+    return (cache != NULL) ? cache->map->size : 0;
+}
+
+/**
+ * @brief Returns the total charge of the cached entries.
+ * @param cache Pointer to the cache.
+ * @return The summed charge.
+ */
+size_t lru_cache_charge(const lru_cache_t *cache) {
+    return (cache != NULL) ? cache->charge : 0;
+}
@@ -0,0 +1,135 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Bounded cache that evicts the least recently used entry.
+// The cache is a chained map_t whose entry list doubles as the recency list:
+// every node already carries the links, so the cache costs no memory beyond the
+// map itself, and a hit moves its node to the back of the list in O(1) without
+// a second lookup. Evicted entries are released through the key and value free
+// functions. Like map_t, a cache is not thread-safe.
+typedef struct lru_cache_t lru_cache_t;
+
+// Function pointer for weighing cache entries
+// Returns how much of the cache's capacity an entry uses, for example its size in bytes.
+typedef size_t (*lru_charge_func_t)(const void *key, const void *value);
+
+/**
+ * @brief Creates an LRU cache.
+ * @param capacity Total charge the cache holds before it evicts: entries, or the unit of charge_func.
+ * @param charge_func Optional: Weighs each entry. NULL charges every entry 1, so capacity counts entries.
+ * @param hash_func Function to hash keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param compare_func Function to compare keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param key_free_func Optional: Function to free key memory when a key is evicted or removed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is evicted or removed. Can be NULL.
+ * @param options Optional: Options of the underlying map. The engine is always MAP_ENGINE_CHAINED,
+ *                and copy_keys is rejected since the arena would keep every evicted key.
+ * @return A pointer to the newly created cache, or NULL on error.
+ */
+lru_cache_t *lru_cache_create(
+    size_t capacity,
+    lru_charge_func_t charge_func,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options);
+
+/**
+ * @brief Destroys the cache, freeing every entry.
+ * @param cache Pointer to the cache to destroy.
+ */
+void lru_cache_destroy(lru_cache_t *cache);
+
+/**
+ * @brief Inserts or replaces an entry, making it the most recently used one.
+ * Then evicts least recently used entries until the cache is within capacity.
+ * The new entry itself is kept even if its charge alone exceeds the capacity.
+ * Replacing an entry frees the old value, and the old key if `key` is a different pointer.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_put(lru_cache_t *cache, void *key, void *value);
+
+/**
+ * @brief Like lru_cache_put, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * Use the _n functions for binary keys; the others treat byte keys as NUL-terminated strings.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_put_n(lru_cache_t *cache, void *key, size_t key_len, void *value);
+
+/**
+ * @brief Retrieves a value and marks its entry as most recently used.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+void *lru_cache_get(lru_cache_t *cache, const void *key);
+
+/**
+ * @brief Like lru_cache_get, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not cached or on invalid input.
+ */
+void *lru_cache_get_n(lru_cache_t *cache, const void *key, size_t key_len);
+
+/**
+ * @brief Retrieves a value without changing the recency order.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not cached.
+ */
+void *lru_cache_peek(const lru_cache_t *cache, const void *key);
+
+/**
+ * @brief Like lru_cache_peek, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return A pointer to the value if found, or NULL if the key is not cached or on invalid input.
+ */
+void *lru_cache_peek_n(const lru_cache_t *cache, const void *key, size_t key_len);
+
+/**
+ * @brief Removes an entry, freeing its key and value through the free functions.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_delete(lru_cache_t *cache, const void *key);
+
+/**
+ * @brief Like lru_cache_delete, for a key of explicit length in a MAP_KEY_BYTES cache.
+ * @param cache Pointer to the cache.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t lru_cache_delete_n(lru_cache_t *cache, const void *key, size_t key_len);
+
+/**
+ * @brief Returns the number of cached entries.
+ * @param cache Pointer to the cache.
+ * @return The number of entries.
+ */
+size_t lru_cache_size(const lru_cache_t *cache);
+
+/**
+ * @brief Returns the total charge of the cached entries.
+ * @param cache Pointer to the cache.
+ * @return The summed charge; equals lru_cache_size without a charge_func.
+ */
+size_t lru_cache_charge(const lru_cache_t *cache);
+
+#endif // LRU_CACHE_H
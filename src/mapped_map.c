@@ -0,0 +1,379 @@
+#include "mapped_map.h"
+#include "hash_map_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MAPPED_MAGIC "CPGMAP\0\1"  // First 8 bytes of every file
+#define MAPPED_VERSION 1
+#define MAPPED_BYTE_ORDER 0x01020304u // Reads back differently on a machine of the other byte order
+#define MAPPED_SEED 0x6d61707065646d61ULL // Hash seed written into new files
+#define MAPPED_MIN_SLOTS 16        // Slot count is a power of two, at least this large
+#define MAPPED_VALUE_ALIGN 8       // Values start on this boundary within the file
+
+// File header. All offsets are from the start of the file.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t seed;             // Seed of _map_hash_bytes_seeded for every key
+    uint64_t count;            // Number of key-value pairs
+    uint64_t slot_count;       // Number of slots, a power of two, load at most 1/2
+    uint64_t slots_offset;
+    uint64_t blob_offset;
+    uint64_t file_size;
+} mapped_header_t;
+
+// Slot of the on-disk table (linear probing). key_offset 0 marks an empty slot,
+// which no key can use because the header comes first.
+typedef struct {
+    uint64_t hash;
+    uint64_t key_offset;
+    uint64_t value_offset;
+    uint32_t key_len;
+    uint32_t value_len;
+} mapped_slot_t;
+
+struct mapped_map_t {
+    const unsigned char *base; // Start of the mapping
+    size_t length;             // Length of the mapping
+    const mapped_header_t *header;
+    const mapped_slot_t *slots;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+static inline size_t _mapped_align(size_t offset) {
+    return (offset + MAPPED_VALUE_ALIGN - 1) / MAPPED_VALUE_ALIGN * MAPPED_VALUE_ALIGN;
+}
+
+static size_t _mapped_value_len(map_value_size_func_t value_size_func, const void *value) {
+    if (value == NULL) {
+        return 0;
+    }
+    return (value_size_func != NULL) ? value_size_func(value) : strlen((const char *)value) + 1;
+}
+
+/**
+ * @brief Lays out a map in memory exactly as it goes to disk.
+ * @param map Pointer to the map.
+ * @param value_size_func Size of each value, or NULL for strings.
+ * @param image Receives the malloc'd file image.
+ * @param image_size Receives its size.
+ * @return MAP_SUCCESS, MAP_ALLOCATION_ERROR, or MAP_FAILURE if a key or value is too large.
+ */
+static map_result_t _mapped_build_image(const map_t *map, map_value_size_func_t value_size_func,
+                                        unsigned char **image, size_t *image_size) {
+    size_t slot_count = _map_round_pow2(map->size * 2, MAPPED_MIN_SLOTS);
+    size_t blob_offset = sizeof(mapped_header_t) + slot_count * sizeof(mapped_slot_t);
+
+    // First pass: size the blob
+    size_t blob_end = blob_offset;
+    map_iter_t it;
+    map_iter_begin((map_t *)map, &it);
+    while (map_iter_next(&it)) {
+        size_t value_len = _mapped_value_len(value_size_func, it.value);
+        if (it.key_len > UINT32_MAX || value_len > UINT32_MAX) {
+            fprintf(stderr, "MAP_FAILURE: Key or value too large to save.\n");
+            map_iter_end(&it);
+            return MAP_FAILURE;
+        }
+        blob_end += it.key_len;
+        blob_end = _mapped_align(blob_end) + value_len + 1; // NUL after every value
+    }
+    map_iter_end(&it);
+
+    unsigned char *data = (unsigned char *)calloc(1, blob_end);
+    if (data == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate file image.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    mapped_header_t *header = (mapped_header_t *)data;
+    memcpy(header->magic, MAPPED_MAGIC, sizeof(header->magic));
+    header->version = MAPPED_VERSION;
+    header->byte_order = MAPPED_BYTE_ORDER;
+    header->seed = MAPPED_SEED;
+    header->count = map->size;
+    header->slot_count = slot_count;
+    header->slots_offset = sizeof(mapped_header_t);
+    header->blob_offset = blob_offset;
+    header->file_size = blob_end;
+
+    // Second pass: copy the bytes and fill the table
+    mapped_slot_t *slots = (mapped_slot_t *)(data + header->slots_offset);
+    size_t cursor = blob_offset;
+    map_iter_begin((map_t *)map, &it);
+    while (map_iter_next(&it)) {
+        size_t value_len = _mapped_value_len(value_size_func, it.value);
+        mapped_slot_t slot;
+        slot.hash = _map_hash_bytes_seeded(it.key, it.key_len, MAPPED_SEED);
+        slot.key_offset = cursor;
+        slot.key_len = (uint32_t)it.key_len;
+        memcpy(data + cursor, it.key, it.key_len);
+        cursor = _mapped_align(cursor + it.key_len);
+        slot.value_offset = cursor;
+        slot.value_len = (uint32_t)value_len;
+        if (value_len > 0) {
+            memcpy(data + cursor, it.value, value_len);
+        }
+        cursor += value_len + 1;
+
+        size_t index = (size_t)slot.hash & (slot_count - 1);
+        while (slots[index].key_offset != 0) {
+            index = (index + 1) & (slot_count - 1);
+        }
+        slots[index] = slot;
+    }
+    map_iter_end(&it);
+
+    *image = data;
+    *image_size = blob_end;
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Writes a MAP_KEY_BYTES map to a file that map_open_mmap can map.
+ * @param map Pointer to the map.
+ * @param path Destination file.
+ * @param value_size_func Size of each value in bytes, or NULL for NUL-terminated strings.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR or MAP_FAILURE on error.
+ */
+map_result_t map_save(const map_t *map, const char *path, map_value_size_func_t value_size_func) {
+    if (map == NULL || path == NULL) {
+        return MAP_FAILURE;
+    }
+    if (map->key_mode != MAP_KEY_BYTES) {
+        fprintf(stderr, "MAP_FAILURE: Only MAP_KEY_BYTES maps can be saved.\n");
+        return MAP_FAILURE;
+    }
+
+    unsigned char *image;
+    size_t image_size;
+    map_result_t res = _mapped_build_image(map, value_size_func, &image, &image_size);
+    if (res != MAP_SUCCESS) {
+        return res;
+    }
+
+    size_t path_len = strlen(path);
+    char *temp_path = (char *)malloc(path_len + sizeof(".tmp"));
+    if (temp_path == NULL) {
+        free(image);
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate file name.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+    memcpy(temp_path, path, path_len);
+    memcpy(temp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    FILE *file = fopen(temp_path, "wb");
+    int ok = file != NULL;
+    if (ok) {
+        ok = fwrite(image, 1, image_size, file) == image_size;
+        ok = (fclose(file) == 0) && ok;
+    }
+    if (ok) {
+        // Replace the old file in one step; existing mappings keep the old contents
+#ifdef _WIN32
+        ok = MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = rename(temp_path, path) == 0;
+#endif
+    }
+    if (!ok) {
+        fprintf(stderr, "MAP_FAILURE: Failed to write %s.\n", path);
+        remove(temp_path);
+        res = MAP_FAILURE;
+    }
+
+    free(temp_path);
+    free(image);
+    return res;
+}
+
+/**
+ * @brief Checks that a mapping holds a complete file written by map_save.
+ */
+static int _mapped_validate(const unsigned char *base, size_t length) {
+    if (length < sizeof(mapped_header_t)) {
+        return 0;
+    }
+    const mapped_header_t *header = (const mapped_header_t *)base;
+    if (memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != MAPPED_VERSION || header->byte_order != MAPPED_BYTE_ORDER ||
+        header->file_size != length) {
+        return 0;
+    }
+    uint64_t slot_count = header->slot_count;
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || header->count >= slot_count ||
+        header->slots_offset != sizeof(mapped_header_t) ||
+        slot_count > (length - header->slots_offset) / sizeof(mapped_slot_t) ||
+        header->blob_offset < header->slots_offset + slot_count * sizeof(mapped_slot_t) ||
+        header->blob_offset > length) {
+        return 0;
+    }
+    // Lookups trust the slots from here on, so check every offset once
+    const mapped_slot_t *slots = (const mapped_slot_t *)(base + header->slots_offset);
+    uint64_t full = 0;
+    for (uint64_t i = 0; i < slot_count; ++i) {
+        const mapped_slot_t *slot = &slots[i];
+        if (slot->key_offset == 0) continue;
+        full++;
+        if (slot->key_offset < header->blob_offset || slot->key_offset > length ||
+            slot->key_len > length - slot->key_offset ||
+            slot->value_offset < header->blob_offset || slot->value_offset >= length ||
+            slot->value_len >= length - slot->value_offset ||
+            slot->value_offset % MAPPED_VALUE_ALIGN != 0 ||
+            base[slot->value_offset + slot->value_len] != '\0') {
+            return 0; // mapped_map_get promises aligned, NUL-terminated values
+        }
+    }
+    // Probes end at an empty slot, so there must be one
+    return full == header->count;
+}
+
+/**
+ * @brief Maps a file written by map_save.
+ * @param path File to map.
+ * @return A pointer to the mapped map, or NULL on error.
+ */
+mapped_map_t *map_open_mmap(const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+
+    mapped_map_t *map = (mapped_map_t *)calloc(1, sizeof(mapped_map_t));
+    if (map == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map structure.\n");
+        return NULL;
+    }
+
+#ifdef _WIN32
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (map->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(map->file, &size) || size.QuadPart == 0) {
+        fprintf(stderr, "MAP_FAILURE: Failed to open %s.\n", path);
+        if (map->file != INVALID_HANDLE_VALUE) CloseHandle(map->file);
+        free(map);
+        return NULL;
+    }
+    map->length = (size_t)size.QuadPart;
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    map->base = (map->mapping != NULL)
+        ? (const unsigned char *)MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0)
+        : NULL;
+    if (map->base == NULL) {
+        fprintf(stderr, "MAP_FAILURE: Failed to map %s.\n", path);
+        if (map->mapping != NULL) CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        free(map);
+        return NULL;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) {
+        fprintf(stderr, "MAP_FAILURE: Failed to open %s.\n", path);
+        if (fd >= 0) close(fd);
+        free(map);
+        return NULL;
+    }
+    map->length = (size_t)st.st_size;
+    void *base = mmap(NULL, map->length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "MAP_FAILURE: Failed to map %s.\n", path);
+        free(map);
+        return NULL;
+    }
+    map->base = (const unsigned char *)base;
+#endif
+
+    if (!_mapped_validate(map->base, map->length)) {
+        fprintf(stderr, "MAP_FAILURE: %s is not a valid map file.\n", path);
+        mapped_map_close(map);
+        return NULL;
+    }
+    map->header = (const mapped_header_t *)map->base;
+    map->slots = (const mapped_slot_t *)(map->base + map->header->slots_offset);
+    return map;
+}
+
+/**
+ * @brief Unmaps the file.
+ * @param map Pointer to the mapped map.
+ */
+void mapped_map_close(mapped_map_t *map) {
+    if (map == NULL) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(map->base);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+#else
+    munmap((void *)map->base, map->length);
+#endif
+    free(map);
+}
+
+/**
+ * @brief Retrieves the value stored for a key, pointing into the mapping.
+ * @param map Pointer to the mapped map.
+ * @param key Pointer to the first key byte.
+ * @param key_len Key length in bytes.
+ * @param value_len Optional: Receives the value length in bytes.
+ * @return A pointer to the value bytes, or NULL if the key is not found.
+ */
+const void *mapped_map_get(const mapped_map_t *map, const void *key, size_t key_len, size_t *value_len) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    uint64_t hash = _map_hash_bytes_seeded(key, key_len, map->header->seed);
+    size_t mask = (size_t)map->header->slot_count - 1;
+    for (size_t index = (size_t)hash & mask;; index = (index + 1) & mask) {
+        const mapped_slot_t *slot = &map->slots[index];
+        if (slot->key_offset == 0) {
+            return NULL; // The load limit guarantees an empty slot
+        }
+        if (slot->hash == hash && slot->key_len == key_len &&
+            memcmp(map->base + slot->key_offset, key, key_len) == 0) {
+            if (value_len != NULL) {
+                *value_len = slot->value_len;
+            }
+            return map->base + slot->value_offset;
+        }
+    }
+}
+
+/**
+ * @brief Checks if a key exists in the mapped map.
+ * @param map Pointer to the mapped map.
+ * @param key Pointer to the first key byte.
+ * @param key_len Key length in bytes.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int mapped_map_contains(const mapped_map_t *map, const void *key, size_t key_len) {
+    return mapped_map_get(map, key, key_len, NULL) != NULL;
+}
+
+/**
+ * @brief Returns the number of key-value pairs in the mapped map.
+ * @param map Pointer to the mapped map.
+ * @return The size of the mapped map.
+ */
+size_t mapped_map_size(const mapped_map_t *map) {
+    return (map != NULL) ? (size_t)map->header->count : 0;
+}
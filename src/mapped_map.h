@@ -0,0 +1,76 @@
+#ifndef MAPPED_MAP_H
+#define MAPPED_MAP_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Read-only map served straight from a memory-mapped file.
+// map_save writes a position-independent hash table: a header (with the hash
+// seed), a flat array of slots holding offsets instead of pointers, and a blob
+// region with the key and value bytes. map_open_mmap maps that file and answers
+// lookups from the mapping without parsing or copying anything, so opening is
+// near-instant and processes mapping the same file share its page cache.
+//
+// Only MAP_KEY_BYTES maps can be saved, since their keys are plain bytes of known
+// length. Values are saved as bytes too (see map_value_size_func_t). The file
+// uses the byte order of the machine that wrote it.
+typedef struct mapped_map_t mapped_map_t;
+
+// Function pointer for sizing values when saving a map
+// Returns the number of bytes of `value` to write.
+typedef size_t (*map_value_size_func_t)(const void *value);
+
+/**
+ * @brief Writes a MAP_KEY_BYTES map to a file that map_open_mmap can map.
+ * The file is written next to `path` and renamed over it once complete, so
+ * processes that still map an older version keep a consistent view.
+ * @param map Pointer to the map. Its keys are saved by length.
+ * @param path Destination file.
+ * @param value_size_func Size of each value in bytes. NULL saves values as NUL-terminated strings.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure,
+ *         MAP_FAILURE on invalid input (including maps with opaque keys) or I/O errors.
+ */
+map_result_t map_save(const map_t *map, const char *path, map_value_size_func_t value_size_func);
+
+/**
+ * @brief Maps a file written by map_save.
+ * @param path File to map.
+ * @return A pointer to the mapped map, or NULL if the file cannot be mapped or is not valid.
+ */
+mapped_map_t *map_open_mmap(const char *path);
+
+/**
+ * @brief Unmaps the file. Pointers returned by lookups become invalid.
+ * @param map Pointer to the mapped map.
+ */
+void mapped_map_close(mapped_map_t *map);
+
+/**
+ * @brief Retrieves the value stored for a key, pointing into the mapping.
+ * Values are 8-byte aligned and followed by a NUL byte.
+ * @param map Pointer to the mapped map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value_len Optional: Receives the value length in bytes. Can be NULL.
+ * @return A pointer to the value bytes, or NULL if the key is not found.
+ */
+const void *mapped_map_get(const mapped_map_t *map, const void *key, size_t key_len, size_t *value_len);
+
+/**
+ * @brief Checks if a key exists in the mapped map.
+ * @param map Pointer to the mapped map.
+ * @param key Pointer to the first key byte.
+ * @param key_len Key length in bytes.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int mapped_map_contains(const mapped_map_t *map, const void *key, size_t key_len);
+
+/**
+ * @brief Returns the number of key-value pairs in the mapped map.
+ * @param map Pointer to the mapped map.
+ * @return The size of the mapped map.
+ */
+size_t mapped_map_size(const mapped_map_t *map);
+
+#endif // MAPPED_MAP_H
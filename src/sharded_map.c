@@ -0,0 +1,342 @@
+#include "sharded_map.h"
+#include "hash_map_internal.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SHARDED_DEFAULT_SHARDS 16  // Default number of shards
+#define BUILD_CHUNK 16384          // Input pairs a build worker hashes or scatters at a time
+
+struct sharded_map_t {
+    map_t **shards;            // shard_count independent maps with identical settings
+    size_t shard_count;        // Number of shards, a power of two
+    unsigned shard_bits;       // log2(shard_count)
+};
+
+/**
+ * @brief Hashes a key the way its shard will and picks the shard from the top bits.
+ * Shards index with the low bits (or all bits, modulo the bucket count), so the
+ * hash is mixed again before its top bits are taken.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param lookup Receives the prepared lookup for the shard.
+ * @return Index of the shard that owns the key.
+ */
+static size_t _sharded_lookup(const sharded_map_t *map, const void *key, map_lookup_t *lookup) {
+    const map_t *first = map->shards[0];
+    _map_make_lookup(first, key, _map_default_key_len(first, key), lookup);
+    if (map->shard_bits == 0) {
+        return 0;
+    }
+    return (size_t)(_map_mix64(lookup->hash) >> (64 - map->shard_bits));
+}
+
+/**
+ * @brief Creates a sharded map.
+ * @param shards Number of shards, rounded up to a power of two. If 0, uses SHARDED_DEFAULT_SHARDS.
+ * @param hash_func Function to hash keys.
+ * @param compare_func Function to compare keys.
+ * @param key_free_func Optional: Function to free key memory. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory. Can be NULL.
+ * @param options Optional: Creation options applied to every shard. NULL selects the defaults.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+sharded_map_t *sharded_map_create(
+    size_t shards,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options) {
+    sharded_map_t *map = (sharded_map_t *)calloc(1, sizeof(sharded_map_t));
+    if (map == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate map structure.\n");
+        return NULL;
+    }
+
+    map->shard_count = _map_round_pow2((shards > 0) ? shards : SHARDED_DEFAULT_SHARDS, 1);
+    while (((size_t)1 << map->shard_bits) < map->shard_count) {
+        map->shard_bits++;
+    }
+
+    map->shards = (map_t **)calloc(map->shard_count, sizeof(map_t *));
+    if (map->shards == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate shards.\n");
+        free(map);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < map->shard_count; ++i) {
+        map->shards[i] = map_create_with_options(0, hash_func, compare_func,
+                                                 key_free_func, value_free_func, options);
+        if (map->shards[i] == NULL) {
+            sharded_map_destroy(map);
+            return NULL;
+        }
+        // Keys are hashed once with the first shard's parameters, so every shard
+        // shares its seed and never reseeds on its own
+        map->shards[i]->hash_seed[0] = map->shards[0]->hash_seed[0];
+        map->shards[i]->hash_seed[1] = map->shards[0]->hash_seed[1];
+        map->shards[i]->reseed_chain_length = 0;
+    }
+    return map;
+}
+
+/**
+ * @brief Destroys the map and all its shards.
+ * @param map Pointer to the map to destroy.
+ */
+void sharded_map_destroy(sharded_map_t *map) {
+    if (map == NULL) return;
+
+    for (size_t i = 0; i < map->shard_count; ++i) {
+        map_destroy(map->shards[i]); // NULL-safe, for a partially created map
+    }
+    free(map->shards);
+    free(map);
+}
+
+/**
+ * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t sharded_map_insert(sharded_map_t *map, void *key, void *value) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    map_t *shard = map->shards[_sharded_lookup(map, key, &lookup)];
+    return _map_insert_lookup(shard, &lookup, key, value);
+}
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *sharded_map_get(const sharded_map_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    const map_t *shard = map->shards[_sharded_lookup(map, key, &lookup)];
+    void **value = _map_find_lookup(shard, &lookup);
+    return (value != NULL) ? *value : NULL;
+}
+
+/**
+ * @brief Checks if a key exists in the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int sharded_map_contains(const sharded_map_t *map, const void *key) {
+    return sharded_map_get(map, key) != NULL;
+}
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t sharded_map_delete(sharded_map_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    map_t *shard = map->shards[_sharded_lookup(map, key, &lookup)];
+    return _map_remove(shard, &lookup);
+}
+
+/**
+ * @brief Returns the number of key-value pairs across all shards.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t sharded_map_size(const sharded_map_t *map) {
+    if (map == NULL) return 0;
+
+    size_t size = 0;
+    for (size_t i = 0; i < map->shard_count; ++i) {
+        size += map->shards[i]->size;
+    }
+    return size;
+}
+
+/**
+ * @brief Iterates over all key-value pairs, shard by shard.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t sharded_map_iterate(const sharded_map_t *map, map_iter_func_t callback_func, void *user_data) {
+    if (map == NULL || callback_func == NULL) {
+        return MAP_FAILURE;
+    }
+
+    for (size_t i = 0; i < map->shard_count; ++i) {
+        map_result_t res = map->shards[i]->ops->iterate(map->shards[i], callback_func, user_data);
+        if (res != MAP_SUCCESS) {
+            return res;
+        }
+    }
+    return MAP_SUCCESS;
+}
+
+// Shared state of sharded_map_build_parallel.
+// Pass 1 hashes every key and counts pairs per (input chunk, shard). A prefix sum
+// over those counts gives each chunk a private output range per shard, so pass 2
+// scatters pair indexes without synchronization and keeps input order. Pass 3
+// fills one shard per work item.
+typedef struct {
+    sharded_map_t *map;
+    void *const *keys;
+    void *const *values;
+    size_t n;
+    uint64_t *hashes;          // n hashes
+    size_t *key_lens;          // n key lengths (MAP_KEY_BYTES only, otherwise NULL)
+    uint32_t *shard_of;        // n shard indexes
+    size_t *offsets;           // chunks x shard_count: counts after pass 1, write positions after the prefix sum
+    size_t *shard_start;       // shard_count + 1 boundaries into order
+    size_t *order;             // n pair indexes grouped by shard
+    atomic_int failed;         // Set when a shard could not be reserved or filled
+} sharded_build_t;
+
+static void _sharded_build_hash(void *context, size_t worker, size_t begin, size_t end) {
+    sharded_build_t *build = (sharded_build_t *)context;
+    // _map_parallel_for hands out one chunk per call, so begin picks the chunk's row
+    size_t *counts = build->offsets + (begin / BUILD_CHUNK) * build->map->shard_count;
+    (void)worker;
+    for (size_t i = begin; i < end; ++i) {
+        map_lookup_t lookup;
+        size_t shard = _sharded_lookup(build->map, build->keys[i], &lookup);
+        build->hashes[i] = lookup.hash;
+        if (build->key_lens != NULL) {
+            build->key_lens[i] = lookup.key_len;
+        }
+        build->shard_of[i] = (uint32_t)shard;
+        counts[shard]++;
+    }
+}
+
+static void _sharded_build_scatter(void *context, size_t worker, size_t begin, size_t end) {
+    sharded_build_t *build = (sharded_build_t *)context;
+    size_t *positions = build->offsets + (begin / BUILD_CHUNK) * build->map->shard_count;
+    (void)worker;
+    for (size_t i = begin; i < end; ++i) {
+        build->order[positions[build->shard_of[i]]++] = i;
+    }
+}
+
+static void _sharded_build_fill(void *context, size_t worker, size_t begin, size_t end) {
+    sharded_build_t *build = (sharded_build_t *)context;
+    (void)worker;
+    for (size_t s = begin; s < end; ++s) {
+        map_t *shard = build->map->shards[s];
+        size_t first = build->shard_start[s];
+        size_t last = build->shard_start[s + 1];
+        if (map_reserve(shard, shard->size + (last - first)) != MAP_SUCCESS) {
+            atomic_store(&build->failed, 1);
+            continue;
+        }
+        for (size_t j = first; j < last; ++j) {
+            size_t i = build->order[j];
+            map_lookup_t lookup = { build->keys[i], 0, build->hashes[i] };
+            if (build->key_lens != NULL) {
+                lookup.key_len = build->key_lens[i];
+            }
+            if (_map_insert_lookup(shard, &lookup, build->keys[i], build->values[i]) != MAP_SUCCESS) {
+                atomic_store(&build->failed, 1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Inserts n key-value pairs, filling the shards on several threads.
+ * @param map Pointer to the map.
+ * @param keys Array of n keys.
+ * @param values Array of n values.
+ * @param n Number of pairs.
+ * @param threads Maximum number of threads, including the caller.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR or MAP_FAILURE on error.
+ */
+map_result_t sharded_map_build_parallel(
+    sharded_map_t *map,
+    void *const *keys,
+    void *const *values,
+    size_t n,
+    size_t threads) {
+    if (map == NULL || (n > 0 && (keys == NULL || values == NULL))) {
+        return MAP_FAILURE;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (keys[i] == NULL) {
+            return MAP_FAILURE;
+        }
+    }
+    if (n == 0) {
+        return MAP_SUCCESS;
+    }
+
+    size_t shards = map->shard_count;
+    size_t chunks = n / BUILD_CHUNK + (n % BUILD_CHUNK != 0);
+    sharded_build_t build = { map, keys, values, n, NULL, NULL, NULL, NULL, NULL, NULL, 0 };
+    build.hashes = (uint64_t *)malloc(n * sizeof(uint64_t));
+    int byte_keys = map->shards[0]->key_mode == MAP_KEY_BYTES;
+    if (byte_keys) {
+        // Measured once in the hash pass instead of again in the fill pass
+        build.key_lens = (size_t *)malloc(n * sizeof(size_t));
+    }
+    build.shard_of = (uint32_t *)malloc(n * sizeof(uint32_t));
+    build.offsets = (size_t *)calloc(chunks * shards, sizeof(size_t));
+    build.shard_start = (size_t *)malloc((shards + 1) * sizeof(size_t));
+    build.order = (size_t *)malloc(n * sizeof(size_t));
+
+    map_result_t res = MAP_SUCCESS;
+    if (build.hashes == NULL || (byte_keys && build.key_lens == NULL) || build.shard_of == NULL || build.offsets == NULL ||
+        build.shard_start == NULL || build.order == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate build buffers.\n");
+        res = MAP_ALLOCATION_ERROR;
+    } else {
+        _map_parallel_for(threads, n, BUILD_CHUNK, _sharded_build_hash, &build);
+
+        // Exclusive prefix sum, shard-major, so every shard's pairs are contiguous
+        // and appear in input order
+        size_t position = 0;
+        for (size_t s = 0; s < shards; ++s) {
+            build.shard_start[s] = position;
+            for (size_t c = 0; c < chunks; ++c) {
+                size_t count = build.offsets[c * shards + s];
+                build.offsets[c * shards + s] = position;
+                position += count;
+            }
+        }
+        build.shard_start[shards] = position;
+
+        _map_parallel_for(threads, n, BUILD_CHUNK, _sharded_build_scatter, &build);
+        _map_parallel_for(threads, shards, 1, _sharded_build_fill, &build);
+
+        if (atomic_load(&build.failed)) {
+            res = MAP_ALLOCATION_ERROR;
+        }
+    }
+
+    free(build.hashes);
+    free(build.key_lens);
+    free(build.shard_of);
+    free(build.offsets);
+    free(build.shard_start);
+    free(build.order);
+    return res;
+}
@@ -0,0 +1,109 @@
+#ifndef SHARDED_MAP_H
+#define SHARDED_MAP_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// Hash map split into independent map_t shards.
+// Every key is hashed once; the top bits of the (mixed) hash pick the shard and
+// the shard indexes with the same hash, so shards stay evenly loaded and no key
+// is hashed twice. Shards share nothing, which lets sharded_map_build_parallel
+// fill them on separate threads. Like map_t, a sharded map is not thread-safe.
+typedef struct sharded_map_t sharded_map_t;
+
+/**
+ * @brief Creates a sharded map.
+ * @param shards Number of shards, rounded up to a power of two. If 0, uses a default.
+ * @param hash_func Function to hash keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param compare_func Function to compare keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param key_free_func Optional: Function to free key memory when a key is removed or map is destroyed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value is removed or map is destroyed. Can be NULL.
+ * @param options Optional: Creation options applied to every shard. NULL selects the defaults.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+sharded_map_t *sharded_map_create(
+    size_t shards,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options);
+
+/**
+ * @brief Destroys the map and all its shards.
+ * @param map Pointer to the map to destroy.
+ */
+void sharded_map_destroy(sharded_map_t *map);
+
+/**
+ * @brief Inserts a key-value pair. If the key already exists, its value is updated.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on resize failure, MAP_FAILURE on invalid input.
+ */
+map_result_t sharded_map_insert(sharded_map_t *map, void *key, void *value);
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @return A pointer to the value if found, or NULL if the key is not found.
+ */
+void *sharded_map_get(const sharded_map_t *map, const void *key);
+
+/**
+ * @brief Checks if a key exists in the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @return 1 if the key exists, 0 otherwise.
+ */
+int sharded_map_contains(const sharded_map_t *map, const void *key);
+
+/**
+ * @brief Deletes a key-value pair from the map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t sharded_map_delete(sharded_map_t *map, const void *key);
+
+/**
+ * @brief Returns the number of key-value pairs across all shards.
+ * @param map Pointer to the map.
+ * @return The current size of the map.
+ */
+size_t sharded_map_size(const sharded_map_t *map);
+
+/**
+ * @brief Iterates over all key-value pairs, shard by shard.
+ * @param map Pointer to the map.
+ * @param callback_func The function to call for each key-value pair.
+ * @param user_data An opaque pointer to user-defined data passed to the callback.
+ * @return MAP_SUCCESS if iteration completed, MAP_FAILURE if callback stopped it or on invalid input.
+ */
+map_result_t sharded_map_iterate(const sharded_map_t *map, map_iter_func_t callback_func, void *user_data);
+
+/**
+ * @brief Inserts n key-value pairs, filling the shards on up to `threads` threads.
+ * Keys are hashed in parallel and partitioned by shard; each shard is then
+ * reserved for exactly its share of the input and filled by one thread, so no
+ * shard resizes during the build. Within a shard, pairs are inserted in input
+ * order, so a key given twice keeps the later value, as with repeated inserts.
+ * @param map Pointer to the map.
+ * @param keys Array of n keys. None may be NULL.
+ * @param values Array of n values.
+ * @param n Number of pairs.
+ * @param threads Maximum number of threads, including the caller. 0 or 1 builds on the calling thread.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR if memory ran out (some pairs may then be
+ *         missing), MAP_FAILURE on invalid input.
+ */
+map_result_t sharded_map_build_parallel(
+    sharded_map_t *map,
+    void *const *keys,
+    void *const *values,
+    size_t n,
+    size_t threads);
+
+#endif // SHARDED_MAP_H
@@ -0,0 +1,626 @@
+#include "ttl_map.h"
+#include "hash_map_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TTL_WHEEL_BITS 6                                  // log2 of the slots per level
+#define TTL_WHEEL_SLOTS (1u << TTL_WHEEL_BITS)            // Slots per wheel level
+#define TTL_WHEEL_MASK (TTL_WHEEL_SLOTS - 1)
+#define TTL_WHEEL_LEVELS 4                                // Levels; together they span 2^24 ticks
+#define TTL_WHEEL_SPAN (1ull << (TTL_WHEEL_BITS * TTL_WHEEL_LEVELS))
+
+typedef struct ttl_entry_t ttl_entry_t;
+
+// Expiry record of one key; the underlying map stores it as the key's value
+struct ttl_entry_t {
+    void *key;                 // Key as stored in the map
+    void *value;               // Caller's value
+    uint64_t hash;             // Hash of the key when it was inserted
+    size_t key_len;            // Key length in bytes (MAP_KEY_BYTES only)
+    uint64_t expires;          // Time at which the entry expires
+    ttl_entry_t *prev;         // Previous entry in the same wheel slot
+    ttl_entry_t *next;         // Next entry in the same wheel slot
+    uint8_t level;             // Wheel level holding the entry
+    uint8_t slot;              // Slot within that level
+};
+
+struct ttl_map_t {
+    map_t *map;                // Keys to ttl_entry_t records; owns and frees the keys
+    free_func_t value_free_func; // Optional: Frees values of expired and removed entries
+    uint64_t current;          // Time the wheel has advanced to; every earlier slot is processed
+    uint64_t occupied[TTL_WHEEL_LEVELS]; // Bit per non-empty slot, so empty slots are skipped
+    ttl_entry_t *slots[TTL_WHEEL_LEVELS][TTL_WHEEL_SLOTS]; // Heads of the slot lists
+};
+
+/**
+ * @brief Removes an entry's key from the map, which frees the key.
+ * Uses the hash saved in the entry, so expiring a key does not hash it again.
+ * @param map Pointer to the TTL map.
+ * @param entry Entry whose key to remove.
+ */
+static void _ttl_remove_key(ttl_map_t *map, const ttl_entry_t *entry) {
+    map_lookup_t lookup = { entry->key, entry->key_len, entry->hash };
+    if (_map_remove(map->map, &lookup) == MAP_KEY_NOT_FOUND) {
+        // A keyed map that reseeded since the insert now hashes the key differently
+        _map_make_lookup(map->map, entry->key, entry->key_len, &lookup);
+        _map_remove(map->map, &lookup);
+    }
+}
+
+/**
+ * @brief Expiry time of an entry inserted at `now`, saturating instead of wrapping.
+ */
+static inline uint64_t _ttl_expiry(uint64_t now, uint64_t ttl) {
+    return (ttl > UINT64_MAX - now) ? UINT64_MAX : now + ttl;
+}
+
+/**
+ * @brief Files an entry into the wheel slot that comes due at or before its expiry.
+ * An entry that has already expired goes into the level-0 slot of the current
+ * tick, which is otherwise empty and is drained first by the next expire call.
+ * An entry whose expiry lies beyond the wheel's span waits in the last slot
+ * of the top level and is filed again when that slot comes due.
+ * @param map Pointer to the TTL map.
+ * @param entry Entry to file; must not be in the wheel.
+ */
+static void _ttl_wheel_add(ttl_map_t *map, ttl_entry_t *entry) {
+    uint64_t when = (entry->expires < map->current) ? map->current : entry->expires;
+    uint64_t delta = when - map->current;
+    if (delta >= TTL_WHEEL_SPAN) {
+        when = map->current + TTL_WHEEL_SPAN - 1;
+        delta = TTL_WHEEL_SPAN - 1;
+    }
+
+    // The coarsest level whose slots still tell `when` apart from the current tick
+    unsigned level = 0;
+    while (level < TTL_WHEEL_LEVELS - 1 && delta >= (1ull << (TTL_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    unsigned slot = (unsigned)(when >> (TTL_WHEEL_BITS * level)) & TTL_WHEEL_MASK;
+
+    entry->level = (uint8_t)level;
+    entry->slot = (uint8_t)slot;
+    entry->prev = NULL;
+    entry->next = map->slots[level][slot];
+    if (entry->next != NULL) {
+        entry->next->prev = entry;
+    }
+    map->slots[level][slot] = entry;
+    map->occupied[level] |= 1ull << slot;
+}
+
+/**
+ * @brief Takes an entry out of its wheel slot.
+ */
+static void _ttl_wheel_unlink(ttl_map_t *map, ttl_entry_t *entry) {
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        map->slots[entry->level][entry->slot] = entry->next;
+        if (entry->next == NULL) {
+            map->occupied[entry->level] &= ~(1ull << entry->slot);
+        }
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    }
+}
+
+/**
+ * @brief Detaches the whole list of a wheel slot.
+ * @return The former head of the slot's list.
+ */
+static ttl_entry_t *_ttl_wheel_take(ttl_map_t *map, unsigned level, unsigned slot) {
+    ttl_entry_t *head = map->slots[level][slot];
+    map->slots[level][slot] = NULL;
+    map->occupied[level] &= ~(1ull << slot);
+    return head;
+}
+
+/**
+ * @brief Removes an entry from the wheel and the map and frees it.
+ * @param map Pointer to the TTL map.
+ * @param entry Entry to drop.
+ * @param lookup Lookup of the entry's key. May point at the stored key itself.
+ */
+static void _ttl_drop(ttl_map_t *map, ttl_entry_t *entry, const map_lookup_t *lookup) {
+    _ttl_wheel_unlink(map, entry);
+    _map_remove(map->map, lookup); // Frees the key
+    if (map->value_free_func && entry->value) {
+        map->value_free_func(entry->value);
+    }
+    free(entry);
+}
+
+/**
+ * @brief Finds the next tick after the current one at which a non-empty slot comes due.
+ * A level-0 slot comes due on its tick; a slot on a higher level comes due when
+ * the level below wraps around into it.
+ * @param map Pointer to the TTL map.
+ * @param due Receives the tick.
+ * @return 1 if a slot comes due, or 0 if the wheel is empty or nothing can come due after the current tick.
+ */
+static int _ttl_next_due(const ttl_map_t *map, uint64_t *due) {
+    int found = 0;
+    for (unsigned level = 0; level < TTL_WHEEL_LEVELS; level++) {
+        uint64_t bits = map->occupied[level];
+        if (bits == 0) continue;
+
+        unsigned shift = TTL_WHEEL_BITS * level;
+        uint64_t block = map->current >> shift;
+        // Rotate so that bit 0 is the slot of the next block; the current block is processed
+        unsigned start = (unsigned)(block + 1) & TTL_WHEEL_MASK;
+        uint64_t rotated = (start == 0) ? bits : ((bits >> start) | (bits << (TTL_WHEEL_SLOTS - start)));
+        uint64_t step = 1 + (uint64_t)__builtin_ctzll(rotated);
+        if (step > (UINT64_MAX >> shift) - block) continue; // Would come due past the end of time
+
+        uint64_t tick = (block + step) << shift;
+        if (!found || tick < *due) {
+            *due = tick;
+            found = 1;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Refiles the entries of every higher-level slot that comes due at the current tick.
+ * Moving down a level only ever brings an entry closer to its own slot, so each
+ * entry is touched at most once per level before it expires.
+ * @param map Pointer to the TTL map.
+ */
+static void _ttl_cascade(ttl_map_t *map) {
+    for (unsigned level = 1; level < TTL_WHEEL_LEVELS; level++) {
+        unsigned shift = TTL_WHEEL_BITS * level;
+        if ((map->current & ((1ull << shift) - 1)) != 0) break; // The level below has not wrapped
+
+        unsigned slot = (unsigned)(map->current >> shift) & TTL_WHEEL_MASK;
+        ttl_entry_t *entry = _ttl_wheel_take(map, level, slot);
+        while (entry != NULL) {
+            ttl_entry_t *next = entry->next;
+            _ttl_wheel_add(map, entry);
+            entry = next;
+        }
+    }
+}
+
+/**
+ * @brief Creates a TTL map.
+ * @param now Current time; the wheel starts here.
+ * @param hash_func Function to hash keys.
+ * @param compare_func Function to compare keys.
+ * @param key_free_func Optional: Function to free key memory. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory. Can be NULL.
+ * @param options Optional: Options of the underlying map. NULL selects the defaults.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+ttl_map_t *ttl_map_create(
+    uint64_t now,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options) {
+    if (options != NULL && (options->copy_keys || options->bloom_bits_per_key > 0)) {
+        fprintf(stderr, "MAP_FAILURE: TTL maps cannot use copy_keys or a Bloom filter; both keep expired keys.\n");
+        return NULL;
+    }
+
+    ttl_map_t *map = (ttl_map_t *)calloc(1, sizeof(ttl_map_t));
+    if (map == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate TTL map structure.\n");
+        return NULL;
+    }
+
+    // The map frees keys itself; values hang off the expiry records
+    map->map = map_create_with_options(0, hash_func, compare_func, key_free_func, NULL, options);
+    if (map->map == NULL) {
+        free(map);
+        return NULL;
+    }
+    map->value_free_func = value_free_func;
+    map->current = now;
+    return map;
+}
+
+/**
+ * @brief Destroys the map, freeing every entry whether expired or not.
+ * @param map Pointer to the map to destroy.
+ */
+void ttl_map_destroy(ttl_map_t *map) {
+    if (map == NULL) return;
+
+    // Every entry sits in exactly one wheel slot
+    for (unsigned level = 0; level < TTL_WHEEL_LEVELS; level++) {
+        for (unsigned slot = 0; slot < TTL_WHEEL_SLOTS; slot++) {
+            ttl_entry_t *entry = map->slots[level][slot];
+            while (entry != NULL) {
+                ttl_entry_t *next = entry->next;
+                if (map->value_free_func && entry->value) {
+                    map->value_free_func(entry->value);
+                }
+                free(entry);
+                entry = next;
+            }
+        }
+    }
+    map_destroy(map->map);
+    free(map);
+}
+
+/**
+ * @brief Inserts a prepared key that expires `ttl` time units from `now`, or replaces its value and expiry.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure.
+ */
+static map_result_t _ttl_insert(ttl_map_t *map, const map_lookup_t *lookup, void *key, void *value,
+                                uint64_t ttl, uint64_t now) {
+    // Allocated up front so a failure leaves the map untouched
+    ttl_entry_t *fresh = (ttl_entry_t *)malloc(sizeof(ttl_entry_t));
+    if (fresh == NULL) {
+        fprintf(stderr, "MAP_ALLOCATION_ERROR: Failed to allocate TTL entry.\n");
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    int inserted;
+    void **stored = _map_entry_lookup(map->map, lookup, key, &inserted);
+    if (stored == NULL) {
+        free(fresh);
+        return MAP_ALLOCATION_ERROR;
+    }
+
+    ttl_entry_t *entry;
+    if (inserted) {
+        entry = fresh;
+        entry->key = key;
+        *stored = entry;
+    } else {
+        free(fresh);
+        entry = (ttl_entry_t *)*stored;
+        _ttl_wheel_unlink(map, entry);
+        if (map->value_free_func && entry->value && entry->value != value) {
+            map->value_free_func(entry->value);
+        }
+        // The stored key stays; an equal key passed in is no longer needed
+        if (map->map->key_free_func && key != entry->key) {
+            map->map->key_free_func(key);
+        }
+    }
+    entry->hash = lookup->hash;
+    entry->key_len = lookup->key_len;
+    entry->value = value;
+    entry->expires = _ttl_expiry(now, ttl);
+    _ttl_wheel_add(map, entry);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Looks up the live entry of a prepared key, dropping it if it has expired.
+ * @return The entry, or NULL if the key is absent or expired.
+ */
+static ttl_entry_t *_ttl_find_live(ttl_map_t *map, const map_lookup_t *lookup, uint64_t now) {
+    void **stored = _map_find_lookup(map->map, lookup);
+    if (stored == NULL) {
+        return NULL;
+    }
+
+    ttl_entry_t *entry = (ttl_entry_t *)*stored;
+    if (entry->expires <= now) {
+        _ttl_drop(map, entry, lookup);
+        return NULL;
+    }
+    return entry;
+}
+
+/**
+ * @brief Gives a prepared key a new time to live if it is live.
+ * @return MAP_SUCCESS on success, MAP_KEY_NOT_FOUND if the key is absent or expired.
+ */
+static map_result_t _ttl_touch(ttl_map_t *map, const map_lookup_t *lookup, uint64_t ttl, uint64_t now) {
+    ttl_entry_t *entry = _ttl_find_live(map, lookup, now);
+    if (entry == NULL) {
+        return MAP_KEY_NOT_FOUND;
+    }
+    _ttl_wheel_unlink(map, entry);
+    entry->expires = _ttl_expiry(now, ttl);
+    _ttl_wheel_add(map, entry);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Deletes a prepared key, whether expired or not.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found.
+ */
+static map_result_t _ttl_delete(ttl_map_t *map, const map_lookup_t *lookup) {
+    void **stored = _map_find_lookup(map->map, lookup);
+    if (stored == NULL) {
+        return MAP_KEY_NOT_FOUND;
+    }
+    _ttl_drop(map, (ttl_entry_t *)*stored, lookup);
+    return MAP_SUCCESS;
+}
+
+/**
+ * @brief Inserts a key that expires `ttl` time units from `now`, or replaces its value and expiry.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @param ttl Time to live.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_insert(ttl_map_t *map, void *key, void *value, uint64_t ttl, uint64_t now) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, _map_default_key_len(map->map, key), &lookup);
+    return _ttl_insert(map, &lookup, key, value, ttl, now);
+}
+
+/**
+ * @brief Like ttl_map_insert, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @param ttl Time to live.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_insert_n(ttl_map_t *map, void *key, size_t key_len, void *value, uint64_t ttl, uint64_t now) {
+    if (map == NULL || key == NULL || map->map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, key_len, &lookup);
+    return _ttl_insert(map, &lookup, key, value, ttl, now);
+}
+
+/**
+ * @brief Retrieves the value of a key that has not expired.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @param now Current time.
+ * @return A pointer to the value if found and live, or NULL otherwise.
+ */
+void *ttl_map_get(ttl_map_t *map, const void *key, uint64_t now) {
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, _map_default_key_len(map->map, key), &lookup);
+    ttl_entry_t *entry = _ttl_find_live(map, &lookup, now);
+    return (entry != NULL) ? entry->value : NULL;
+}
+
+/**
+ * @brief Like ttl_map_get, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param now Current time.
+ * @return A pointer to the value if found and live, or NULL otherwise or on invalid input.
+ */
+void *ttl_map_get_n(ttl_map_t *map, const void *key, size_t key_len, uint64_t now) {
+    if (map == NULL || key == NULL || map->map->key_mode != MAP_KEY_BYTES) {
+        return NULL;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, key_len, &lookup);
+    ttl_entry_t *entry = _ttl_find_live(map, &lookup, now);
+    return (entry != NULL) ? entry->value : NULL;
+}
+
+/**
+ * @brief Checks if a key exists and has not expired.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @param now Current time.
+ * @return 1 if the key is live, 0 otherwise.
+ */
+int ttl_map_contains(ttl_map_t *map, const void *key, uint64_t now) {
+    if (map == NULL || key == NULL) {
+        return 0;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, _map_default_key_len(map->map, key), &lookup);
+    return _ttl_find_live(map, &lookup, now) != NULL;
+}
+
+/**
+ * @brief Like ttl_map_contains, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param now Current time.
+ * @return 1 if the key is live, 0 otherwise or on invalid input.
+ */
+int ttl_map_contains_n(ttl_map_t *map, const void *key, size_t key_len, uint64_t now) {
+    if (map == NULL || key == NULL || map->map->key_mode != MAP_KEY_BYTES) {
+        return 0;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, key_len, &lookup);
+    return _ttl_find_live(map, &lookup, now) != NULL;
+}
+
+/**
+ * @brief Gives a live key a new time to live.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param ttl New time to live, counted from `now`.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_KEY_NOT_FOUND if the key is absent or expired, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_touch(ttl_map_t *map, const void *key, uint64_t ttl, uint64_t now) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, _map_default_key_len(map->map, key), &lookup);
+    return _ttl_touch(map, &lookup, ttl, now);
+}
+
+/**
+ * @brief Like ttl_map_touch, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param ttl New time to live, counted from `now`.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_KEY_NOT_FOUND if the key is absent or expired, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_touch_n(ttl_map_t *map, const void *key, size_t key_len, uint64_t ttl, uint64_t now) {
+    if (map == NULL || key == NULL || map->map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, key_len, &lookup);
+    return _ttl_touch(map, &lookup, ttl, now);
+}
+
+/**
+ * @brief Deletes a key, whether expired or not.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_delete(ttl_map_t *map, const void *key) {
+    if (map == NULL || key == NULL) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, _map_default_key_len(map->map, key), &lookup);
+    return _ttl_delete(map, &lookup);
+}
+
+/**
+ * @brief Like ttl_map_delete, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_delete_n(ttl_map_t *map, const void *key, size_t key_len) {
+    if (map == NULL || key == NULL || map->map->key_mode != MAP_KEY_BYTES) {
+        return MAP_FAILURE;
+    }
+
+    map_lookup_t lookup;
+    _map_make_lookup(map->map, key, key_len, &lookup);
+    return _ttl_delete(map, &lookup);
+}
+
+/**
+ * @brief Frees an entry that is already out of the wheel, removing its key from the map.
+ */
+static void _ttl_free_expired(ttl_map_t *map, ttl_entry_t *entry) {
+    _ttl_remove_key(map, entry);
+    if (map->value_free_func && entry->value) {
+        map->value_free_func(entry->value);
+    }
+    free(entry);
+}
+
+/**
+ * @brief Removes and frees every entry in the level-0 slot of the current tick.
+ * @param map Pointer to the TTL map.
+ * @return The number of entries removed.
+ */
+static size_t _ttl_expire_current(ttl_map_t *map) {
+    size_t expired = 0;
+    ttl_entry_t *entry = _ttl_wheel_take(map, 0, (unsigned)map->current & TTL_WHEEL_MASK);
+    while (entry != NULL) {
+        ttl_entry_t *next = entry->next;
+        _ttl_free_expired(map, entry);
+        expired++;
+        entry = next;
+    }
+    return expired;
+}
+
+/**
+ * @brief Moves the wheel straight to `now`, expiring or refiling every entry.
+ * Used for jumps of at least a whole wheel span, where stepping slot by slot
+ * would refile entries parked beyond the span once per span crossed.
+ * @param map Pointer to the TTL map.
+ * @param now Current time.
+ * @return The number of entries removed.
+ */
+static size_t _ttl_jump(ttl_map_t *map, uint64_t now) {
+    ttl_entry_t *pending = NULL;
+    for (unsigned level = 0; level < TTL_WHEEL_LEVELS; level++) {
+        while (map->occupied[level] != 0) {
+            unsigned slot = (unsigned)__builtin_ctzll(map->occupied[level]);
+            ttl_entry_t *entry = _ttl_wheel_take(map, level, slot);
+            while (entry != NULL) {
+                ttl_entry_t *next = entry->next;
+                entry->next = pending;
+                pending = entry;
+                entry = next;
+            }
+        }
+    }
+
+    map->current = now;
+    size_t expired = 0;
+    while (pending != NULL) {
+        ttl_entry_t *next = pending->next;
+        if (pending->expires <= now) {
+            _ttl_free_expired(map, pending);
+            expired++;
+        } else {
+            _ttl_wheel_add(map, pending);
+        }
+        pending = next;
+    }
+    return expired;
+}
+
+/**
+ * @brief Advances the timer wheel to `now`, removing and freeing every entry that has expired.
+ * Jumps straight from one non-empty slot to the next, so the cost depends on
+ * the entries that come due, not on how much time has passed. A jump of a
+ * whole wheel span or more refiles every entry once instead.
+ * @param map Pointer to the map.
+ * @param now Current time.
+ * @return The number of entries removed.
+ */
+size_t ttl_map_expire(ttl_map_t *map, uint64_t now) {
+    if (map == NULL || now < map->current) {
+        return 0;
+    }
+    if (now - map->current >= TTL_WHEEL_SPAN) {
+        return _ttl_jump(map, now);
+    }
+
+    // Entries filed after they had already expired
+    size_t expired = _ttl_expire_current(map);
+    uint64_t due;
+    while (_ttl_next_due(map, &due) && due <= now) {
+        map->current = due;
+        _ttl_cascade(map);
+        expired += _ttl_expire_current(map);
+    }
+    map->current = now;
+    return expired;
+}
+
+/**
+ * @brief Returns the number of entries, including expired ones not yet removed.
+ * @param map Pointer to the map.
+ * @return The number of entries.
+ */
+size_t ttl_map_size(const ttl_map_t *map) {
+    return (map != NULL) ? map->map->size : 0;
+}
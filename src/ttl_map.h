@@ -0,0 +1,168 @@
+#ifndef TTL_MAP_H
+#define TTL_MAP_H
+
+#include "hash_map.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hash map whose entries expire after a per-entry time to live.
+// Expiry times sit in a hierarchical timer wheel: four levels of 64 slots, each
+// level 64 times coarser than the one below. An entry waits in the coarsest
+// slot that still separates it from the present and drops a level each time its
+// slot comes due, so ttl_map_expire only touches entries that are due or about
+// to be, and skips empty slots with a bitmap. Cleanup cost grows with the number
+// of expiring entries, not with the size of the map. Reads also drop an expired
+// entry on the spot, so a get never returns a stale value.
+//
+// Time is whatever monotonic integer clock the caller passes as `now`, for
+// example milliseconds; one wheel slot spans one unit. Like map_t, a TTL map is
+// not thread-safe. The plain functions treat MAP_KEY_BYTES keys as NUL-terminated
+// strings; use the _n functions for binary keys.
+typedef struct ttl_map_t ttl_map_t;
+
+/**
+ * @brief Creates a TTL map.
+ * @param now Current time; the wheel starts here.
+ * @param hash_func Function to hash keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param compare_func Function to compare keys. MUST NOT be NULL unless key_mode is MAP_KEY_BYTES.
+ * @param key_free_func Optional: Function to free key memory when a key expires or is removed. Can be NULL.
+ * @param value_free_func Optional: Function to free value memory when a value expires or is removed. Can be NULL.
+ * @param options Optional: Options of the underlying map. copy_keys and Bloom filters are rejected,
+ *                since expired keys would never leave the arena or the filter.
+ * @return A pointer to the newly created map, or NULL on error.
+ */
+ttl_map_t *ttl_map_create(
+    uint64_t now,
+    hash_func_t hash_func,
+    compare_func_t compare_func,
+    free_func_t key_free_func,
+    free_func_t value_free_func,
+    const map_options_t *options);
+
+/**
+ * @brief Destroys the map, freeing every entry whether expired or not.
+ * @param map Pointer to the map to destroy.
+ */
+void ttl_map_destroy(ttl_map_t *map);
+
+/**
+ * @brief Inserts a key that expires `ttl` time units from `now`.
+ * If the key already exists, its value is replaced and its expiry reset: the old
+ * value is freed, the stored key is kept, and `key` is freed through
+ * key_free_func unless it is the stored pointer.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value Pointer to the value.
+ * @param ttl Time to live; the entry expires once the time reaches now + ttl.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_insert(ttl_map_t *map, void *key, void *value, uint64_t ttl, uint64_t now);
+
+/**
+ * @brief Like ttl_map_insert, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param value Pointer to the value.
+ * @param ttl Time to live; the entry expires once the time reaches now + ttl.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_ALLOCATION_ERROR on allocation failure, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_insert_n(ttl_map_t *map, void *key, size_t key_len, void *value, uint64_t ttl, uint64_t now);
+
+/**
+ * @brief Retrieves the value of a key that has not expired.
+ * An expired entry found on the way is removed and freed.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to search for.
+ * @param now Current time.
+ * @return A pointer to the value if found and live, or NULL otherwise.
+ */
+void *ttl_map_get(ttl_map_t *map, const void *key, uint64_t now);
+
+/**
+ * @brief Like ttl_map_get, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param now Current time.
+ * @return A pointer to the value if found and live, or NULL otherwise or on invalid input.
+ */
+void *ttl_map_get_n(ttl_map_t *map, const void *key, size_t key_len, uint64_t now);
+
+/**
+ * @brief Checks if a key exists and has not expired.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to check.
+ * @param now Current time.
+ * @return 1 if the key is live, 0 otherwise.
+ */
+int ttl_map_contains(ttl_map_t *map, const void *key, uint64_t now);
+
+/**
+ * @brief Like ttl_map_contains, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param now Current time.
+ * @return 1 if the key is live, 0 otherwise or on invalid input.
+ */
+int ttl_map_contains_n(ttl_map_t *map, const void *key, size_t key_len, uint64_t now);
+
+/**
+ * @brief Gives a live key a new time to live, for example when a session is used.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param ttl New time to live, counted from `now`.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_KEY_NOT_FOUND if the key is absent or expired, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_touch(ttl_map_t *map, const void *key, uint64_t ttl, uint64_t now);
+
+/**
+ * @brief Like ttl_map_touch, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @param ttl New time to live, counted from `now`.
+ * @param now Current time.
+ * @return MAP_SUCCESS on success, MAP_KEY_NOT_FOUND if the key is absent or expired, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_touch_n(ttl_map_t *map, const void *key, size_t key_len, uint64_t ttl, uint64_t now);
+
+/**
+ * @brief Deletes a key, whether expired or not.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key to delete.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_delete(ttl_map_t *map, const void *key);
+
+/**
+ * @brief Like ttl_map_delete, for a key of explicit length in a MAP_KEY_BYTES map.
+ * @param map Pointer to the map.
+ * @param key Pointer to the first key byte; need not be NUL-terminated.
+ * @param key_len Key length in bytes.
+ * @return MAP_SUCCESS on successful deletion, MAP_KEY_NOT_FOUND if key not found, MAP_FAILURE on invalid input.
+ */
+map_result_t ttl_map_delete_n(ttl_map_t *map, const void *key, size_t key_len);
+
+/**
+ * @brief Advances the timer wheel to `now`, removing and freeing every entry that has expired.
+ * Call it periodically; entries also expire lazily on reads in between.
+ * @param map Pointer to the map.
+ * @param now Current time. Times earlier than a previous call are ignored.
+ * @return The number of entries removed.
+ */
+size_t ttl_map_expire(ttl_map_t *map, uint64_t now);
+
+/**
+ * @brief Returns the number of entries, including expired ones not yet removed.
+ * @param map Pointer to the map.
+ * @return The number of entries.
+ */
+size_t ttl_map_size(const ttl_map_t *map);
+
+#endif // TTL_MAP_H
@@ -0,0 +1,198 @@
+#include "clock_cache.h"
+#include "epoch.h"
+
+#include <munit.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_THREADS 4
+#define TEST_CAPACITY 256        // Entries the cache holds, across TEST_SHARDS shards
+#define TEST_SHARDS 4
+#define TEST_KEYS 4096           // Distinct keys per writer, far beyond the capacity
+#define TEST_HOT_KEYS 64         // Keys readers keep hitting while writers evict
+
+typedef struct {
+    clock_cache_t *cache;
+    unsigned id;
+    atomic_int *writers_left;  // Writers still running, when readers run alongside; else NULL
+} test_worker_t;
+
+static atomic_size_t g_allocated; // Keys and values handed to the cache
+static atomic_size_t g_freed;     // Keys and values the cache gave back
+
+static char *_test_string(unsigned owner, unsigned i) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%u:%u", owner, i);
+    char *string = strdup(buffer);
+    munit_assert_not_null(string);
+    atomic_fetch_add(&g_allocated, 1);
+    return string;
+}
+
+static void _test_free(void *string) {
+    atomic_fetch_add(&g_freed, 1);
+    free(string);
+}
+
+static clock_cache_t *_test_clock_create(void) {
+    atomic_store(&g_allocated, 0);
+    atomic_store(&g_freed, 0);
+    map_options_t options = {0};
+    options.key_mode = MAP_KEY_BYTES;
+    clock_cache_t *cache = clock_cache_create(TEST_CAPACITY, TEST_SHARDS, NULL, NULL,
+                                              _test_free, _test_free, &options);
+    munit_assert_not_null(cache);
+    return cache;
+}
+
+static void _test_run(void *(*func)(void *), test_worker_t *workers, size_t count) {
+    pthread_t threads[TEST_THREADS];
+    for (size_t i = 0; i < count; ++i) {
+        munit_assert_int(pthread_create(&threads[i], NULL, func, &workers[i]), ==, 0);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void *_test_evicting_writer(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    for (unsigned i = 0; i < TEST_KEYS; ++i) {
+        munit_assert_int(clock_cache_put(self->cache, _test_string(self->id + 1, i), _test_string(self->id + 1, i)),
+                         ==, MAP_SUCCESS);
+        if (i % 7 == 0) {
+            char key[32];
+            snprintf(key, sizeof(key), "%u:%u", self->id + 1, i / 2);
+            clock_cache_delete(self->cache, key); // Often already evicted
+        }
+    }
+    if (self->writers_left != NULL) {
+        atomic_fetch_sub_explicit(self->writers_left, 1, memory_order_release);
+    }
+    return NULL;
+}
+
+static MunitResult test_evicting_writers(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    clock_cache_t *cache = _test_clock_create();
+    test_worker_t workers[TEST_THREADS];
+    for (unsigned i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t){ cache, i, NULL };
+    }
+    _test_run(_test_evicting_writer, workers, TEST_THREADS);
+
+    size_t size = clock_cache_size(cache);
+    munit_assert_size(size, >, 0);
+    munit_assert_size(size, <=, TEST_CAPACITY);
+    // Other writers may have evicted a writer's last key, but a hit must be intact
+    for (unsigned t = 0; t < TEST_THREADS; ++t) {
+        char key[32];
+        snprintf(key, sizeof(key), "%u:%u", t + 1, TEST_KEYS - 1);
+        const char *value = (const char *)clock_cache_get(cache, key);
+        if (value != NULL) {
+            munit_assert_string_equal(value, key);
+        }
+    }
+    clock_cache_destroy(cache);
+    munit_assert_size(atomic_load(&g_freed), ==, atomic_load(&g_allocated));
+    return MUNIT_OK;
+}
+
+static void *_test_replacing_writer(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    // Every writer puts the same keys, which all fit, so only replacements race
+    for (unsigned round = 0; round < 16; ++round) {
+        for (unsigned i = 0; i < TEST_HOT_KEYS; ++i) {
+            unsigned k = (i * 7 + self->id * 13 + round) % TEST_HOT_KEYS;
+            munit_assert_int(clock_cache_put(self->cache, _test_string(0, k), _test_string(0, k)), ==, MAP_SUCCESS);
+        }
+    }
+    return NULL;
+}
+
+static MunitResult test_replacing_writers(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    clock_cache_t *cache = _test_clock_create();
+    test_worker_t workers[TEST_THREADS];
+    for (unsigned i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t){ cache, i, NULL };
+    }
+    _test_run(_test_replacing_writer, workers, TEST_THREADS);
+
+    // Hashing may put more than a shard's share of the hot keys in one shard
+    size_t found = 0;
+    for (unsigned i = 0; i < TEST_HOT_KEYS; ++i) {
+        char key[32];
+        snprintf(key, sizeof(key), "0:%u", i);
+        const char *value = (const char *)clock_cache_get(cache, key);
+        if (value != NULL) {
+            munit_assert_string_equal(value, key);
+            found++;
+        }
+    }
+    munit_assert_size(found, ==, clock_cache_size(cache));
+    clock_cache_destroy(cache);
+    munit_assert_size(atomic_load(&g_freed), ==, atomic_load(&g_allocated));
+    return MUNIT_OK;
+}
+
+static void *_test_hot_reader(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    char key[32];
+    while (atomic_load_explicit(self->writers_left, memory_order_acquire) > 0) {
+        for (unsigned i = 0; i < TEST_HOT_KEYS; ++i) {
+            snprintf(key, sizeof(key), "0:%u", i);
+            epoch_enter();
+            // Hits keep setting reference bits while writers sweep the same shards
+            const char *value = (const char *)clock_cache_get(self->cache, key);
+            if (value != NULL) {
+                munit_assert_string_equal(value, key);
+            }
+            epoch_exit();
+        }
+    }
+    return NULL;
+}
+
+static void *_test_reader_or_writer(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    return (self->id < TEST_THREADS / 2) ? _test_hot_reader(arg) : _test_evicting_writer(arg);
+}
+
+static MunitResult test_readers_during_eviction(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    clock_cache_t *cache = _test_clock_create();
+    for (unsigned i = 0; i < TEST_HOT_KEYS; ++i) {
+        munit_assert_int(clock_cache_put(cache, _test_string(0, i), _test_string(0, i)), ==, MAP_SUCCESS);
+    }
+    atomic_int writers_left = TEST_THREADS - TEST_THREADS / 2;
+    test_worker_t workers[TEST_THREADS];
+    for (unsigned i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t){ cache, i, &writers_left };
+    }
+    _test_run(_test_reader_or_writer, workers, TEST_THREADS);
+
+    munit_assert_size(clock_cache_size(cache), <=, TEST_CAPACITY);
+    clock_cache_destroy(cache);
+    munit_assert_size(atomic_load(&g_freed), ==, atomic_load(&g_allocated));
+    return MUNIT_OK;
+}
+
+static MunitTest tests[] = {
+    { (char *)"/evicting-writers", test_evicting_writers, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/replacing-writers", test_replacing_writers, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/readers-during-eviction", test_readers_during_eviction, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+};
+
+static const MunitSuite suite = { (char *)"/clock_cache", tests, NULL, 1, MUNIT_SUITE_OPTION_NONE };
+
+int main(int argc, char *argv[]) {
+    return munit_suite_main(&suite, NULL, argc, argv);
+}
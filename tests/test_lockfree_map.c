@@ -0,0 +1,202 @@
+#include "epoch.h"
+#include "lockfree_map.h"
+
+#include <munit.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_THREADS 4
+#define TEST_KEYS 4096           // Keys per writer in the disjoint test
+#define TEST_SHARED_KEYS 256     // Keys every writer fights over
+#define TEST_ROUNDS 20           // Passes over the shared keys per writer
+
+typedef struct {
+    lfmap_t *map;
+    unsigned id;
+    atomic_int *writers_left;  // Writers still running, when readers run alongside; else NULL
+} test_worker_t;
+
+static char *_test_key(unsigned owner, unsigned i) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%u:%u", owner, i);
+    char *key = strdup(buffer);
+    munit_assert_not_null(key);
+    return key;
+}
+
+static lfmap_t *_test_lfmap_create(void) {
+    // Few buckets and stripes, so writers collide and resize while racing
+    lfmap_t *map = lfmap_create(8, 4, hash_string, compare_string, free, free);
+    munit_assert_not_null(map);
+    return map;
+}
+
+static void _test_run(void *(*func)(void *), test_worker_t *workers, size_t count) {
+    pthread_t threads[TEST_THREADS];
+    for (size_t i = 0; i < count; ++i) {
+        munit_assert_int(pthread_create(&threads[i], NULL, func, &workers[i]), ==, 0);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void *_test_disjoint_writer(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    for (unsigned i = 0; i < TEST_KEYS; ++i) {
+        munit_assert_int(lfmap_insert(self->map, _test_key(self->id, i), _test_key(self->id, i)), ==, MAP_SUCCESS);
+    }
+    for (unsigned i = 1; i < TEST_KEYS; i += 2) {
+        char *key = _test_key(self->id, i);
+        munit_assert_int(lfmap_delete(self->map, key), ==, MAP_SUCCESS);
+        free(key);
+    }
+    // Replace the survivors; the map keeps its key and frees ours
+    for (unsigned i = 0; i < TEST_KEYS; i += 2) {
+        munit_assert_int(lfmap_insert(self->map, _test_key(self->id, i), _test_key(self->id, i)), ==, MAP_SUCCESS);
+    }
+    return NULL;
+}
+
+static int _test_count(const void *key, void *value, void *user_data) {
+    munit_assert_string_equal((const char *)key, (const char *)value);
+    (*(size_t *)user_data)++;
+    return 0;
+}
+
+static MunitResult test_disjoint_writers(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    lfmap_t *map = _test_lfmap_create();
+    test_worker_t workers[TEST_THREADS];
+    for (unsigned i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t){ map, i, NULL };
+    }
+    _test_run(_test_disjoint_writer, workers, TEST_THREADS);
+
+    munit_assert_size(lfmap_size(map), ==, TEST_THREADS * TEST_KEYS / 2);
+    size_t visited = 0;
+    munit_assert_int(lfmap_iterate(map, _test_count, &visited), ==, MAP_SUCCESS);
+    munit_assert_size(visited, ==, TEST_THREADS * TEST_KEYS / 2);
+    for (unsigned t = 0; t < TEST_THREADS; ++t) {
+        for (unsigned i = 0; i < TEST_KEYS; ++i) {
+            char *key = _test_key(t, i);
+            const char *value = (const char *)lfmap_get(map, key);
+            if (i % 2 == 0) {
+                munit_assert_not_null(value);
+                munit_assert_string_equal(value, key);
+            } else {
+                munit_assert_null(value);
+            }
+            free(key);
+        }
+    }
+    lfmap_destroy(map);
+    return MUNIT_OK;
+}
+
+static void *_test_shared_writer(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    unsigned state = self->id * 2654435761u + 1;
+    for (unsigned round = 0; round < TEST_ROUNDS; ++round) {
+        for (unsigned n = 0; n < TEST_SHARED_KEYS; ++n) {
+            state = state * 1103515245u + 12345u;
+            unsigned i = (state >> 8) % TEST_SHARED_KEYS;
+            if ((state >> 20) % 4 == 0) {
+                char *key = _test_key(0, i);
+                lfmap_delete(self->map, key); // May already be gone
+                free(key);
+            } else {
+                munit_assert_int(lfmap_insert(self->map, _test_key(0, i), _test_key(0, i)), ==, MAP_SUCCESS);
+            }
+        }
+    }
+    if (self->writers_left != NULL) {
+        // Readers check the contents instead of the final state
+        atomic_fetch_sub_explicit(self->writers_left, 1, memory_order_release);
+        return NULL;
+    }
+    for (unsigned i = 0; i < TEST_SHARED_KEYS; ++i) {
+        munit_assert_int(lfmap_insert(self->map, _test_key(0, i), _test_key(0, i)), ==, MAP_SUCCESS);
+    }
+    return NULL;
+}
+
+static MunitResult test_shared_writers(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    lfmap_t *map = _test_lfmap_create();
+    test_worker_t workers[TEST_THREADS];
+    for (unsigned i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t){ map, i, NULL };
+    }
+    _test_run(_test_shared_writer, workers, TEST_THREADS);
+
+    munit_assert_size(lfmap_size(map), ==, TEST_SHARED_KEYS);
+    for (unsigned i = 0; i < TEST_SHARED_KEYS; ++i) {
+        char *key = _test_key(0, i);
+        const char *value = (const char *)lfmap_get(map, key);
+        munit_assert_not_null(value);
+        munit_assert_string_equal(value, key);
+        free(key);
+    }
+    lfmap_destroy(map);
+    return MUNIT_OK;
+}
+
+static void *_test_reader(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    char key[32];
+    while (atomic_load_explicit(self->writers_left, memory_order_acquire) > 0) {
+        for (unsigned i = 0; i < TEST_SHARED_KEYS; ++i) {
+            snprintf(key, sizeof(key), "0:%u", i);
+            epoch_enter();
+            // A value that was replaced or deleted must stay readable until epoch_exit
+            const char *value = (const char *)lfmap_get(self->map, key);
+            if (value != NULL) {
+                munit_assert_string_equal(value, key);
+            }
+            epoch_exit();
+        }
+    }
+    return NULL;
+}
+
+static void *_test_reader_or_writer(void *arg) {
+    test_worker_t *self = (test_worker_t *)arg;
+    return (self->id < TEST_THREADS / 2) ? _test_reader(arg) : _test_shared_writer(arg);
+}
+
+static MunitResult test_readers_during_writes(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    lfmap_t *map = _test_lfmap_create();
+    atomic_int writers_left = TEST_THREADS - TEST_THREADS / 2;
+    test_worker_t workers[TEST_THREADS];
+    for (unsigned i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t){ map, i, &writers_left };
+    }
+    _test_run(_test_reader_or_writer, workers, TEST_THREADS);
+
+    size_t visited = 0;
+    munit_assert_int(lfmap_iterate(map, _test_count, &visited), ==, MAP_SUCCESS);
+    munit_assert_size(visited, ==, lfmap_size(map));
+    lfmap_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitTest tests[] = {
+    { (char *)"/disjoint-writers", test_disjoint_writers, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/shared-writers", test_shared_writers, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/readers-during-writes", test_readers_during_writes, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+};
+
+static const MunitSuite suite = { (char *)"/lockfree_map", tests, NULL, 1, MUNIT_SUITE_OPTION_NONE };
+
+int main(int argc, char *argv[]) {
+    return munit_suite_main(&suite, NULL, argc, argv);
+}
@@ -0,0 +1,176 @@
+#include "ttl_map.h"
+
+#include <munit.h>
+#include <stdint.h>
+
+#define TTL_WHEEL_SPAN (1ull << 24) // Ticks the four-level wheel covers, as in ttl_map.c
+
+static ttl_map_t *_test_ttl_create(uint64_t now) {
+    map_options_t options = {0};
+    options.key_mode = MAP_KEY_BYTES;
+    ttl_map_t *map = ttl_map_create(now, NULL, NULL, NULL, NULL, &options);
+    munit_assert_not_null(map);
+    return map;
+}
+
+static MunitResult test_expires_at_deadline(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    ttl_map_t *map = _test_ttl_create(100);
+    munit_assert_int(ttl_map_insert(map, "a", "1", 10, 100), ==, MAP_SUCCESS);
+
+    munit_assert_size(ttl_map_expire(map, 109), ==, 0);
+    munit_assert_true(ttl_map_contains(map, "a", 109));
+    munit_assert_size(ttl_map_expire(map, 110), ==, 1);
+    munit_assert_false(ttl_map_contains(map, "a", 110));
+    munit_assert_size(ttl_map_size(map), ==, 0);
+
+    ttl_map_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitResult test_zero_ttl(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    ttl_map_t *map = _test_ttl_create(5);
+    munit_assert_int(ttl_map_insert(map, "a", "1", 0, 5), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_insert(map, "b", "2", 0, 5), ==, MAP_SUCCESS);
+
+    // A read drops the entry on the spot; the wheel drains the other one
+    munit_assert_null(ttl_map_get(map, "a", 5));
+    munit_assert_size(ttl_map_expire(map, 5), ==, 1);
+    munit_assert_size(ttl_map_size(map), ==, 0);
+
+    ttl_map_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitResult test_level_boundaries(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    // One tick either side of where an entry moves up a wheel level
+    static const uint64_t ttls[] = {
+        1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+        TTL_WHEEL_SPAN - 1, TTL_WHEEL_SPAN, TTL_WHEEL_SPAN + 1, 3 * TTL_WHEEL_SPAN + 7,
+    };
+    for (size_t i = 0; i < sizeof(ttls) / sizeof(ttls[0]); ++i) {
+        uint64_t start = 1000 + i;
+        ttl_map_t *map = _test_ttl_create(start);
+        munit_assert_int(ttl_map_insert(map, "k", NULL, ttls[i], start), ==, MAP_SUCCESS);
+
+        munit_assert_size(ttl_map_expire(map, start + ttls[i] - 1), ==, 0);
+        munit_assert_true(ttl_map_contains(map, "k", start + ttls[i] - 1));
+        munit_assert_size(ttl_map_expire(map, start + ttls[i]), ==, 1);
+        ttl_map_destroy(map);
+    }
+    return MUNIT_OK;
+}
+
+static MunitResult test_end_of_time(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    ttl_map_t *map = _test_ttl_create(0);
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX), ==, 0);
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX), ==, 0);
+    ttl_map_destroy(map);
+
+    // A saturated expiry lands exactly on UINT64_MAX
+    map = _test_ttl_create(5);
+    munit_assert_int(ttl_map_insert(map, "forever", NULL, UINT64_MAX, 5), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_insert(map, "late", NULL, UINT64_MAX - 10, 5), ==, MAP_SUCCESS);
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX - 1), ==, 1);
+    munit_assert_true(ttl_map_contains(map, "forever", UINT64_MAX - 1));
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX), ==, 1);
+    munit_assert_size(ttl_map_size(map), ==, 0);
+    ttl_map_destroy(map);
+
+    // Stepping the last few ticks one at a time
+    map = _test_ttl_create(UINT64_MAX - 100);
+    munit_assert_int(ttl_map_insert(map, "a", NULL, 50, UINT64_MAX - 100), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_insert(map, "b", NULL, 100, UINT64_MAX - 100), ==, MAP_SUCCESS);
+    size_t expired = 0;
+    for (uint64_t now = UINT64_MAX - 100; now != UINT64_MAX; ++now) {
+        expired += ttl_map_expire(map, now);
+        munit_assert_size(expired, ==, (now >= UINT64_MAX - 50) ? 1 : 0);
+    }
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX), ==, 1);
+    ttl_map_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitResult test_long_jump(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    ttl_map_t *map = _test_ttl_create(0);
+    munit_assert_int(ttl_map_insert(map, "near", NULL, 10, 0), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_insert(map, "far", NULL, UINT64_MAX / 2, 0), ==, MAP_SUCCESS);
+
+    // Far more than a wheel span at once; must not step span by span
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX / 4), ==, 1);
+    munit_assert_true(ttl_map_contains(map, "far", UINT64_MAX / 4));
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX / 2 - 1), ==, 0);
+    munit_assert_size(ttl_map_expire(map, UINT64_MAX / 2), ==, 1);
+
+    // Time going backwards is ignored
+    munit_assert_int(ttl_map_insert(map, "x", NULL, 1, UINT64_MAX / 2), ==, MAP_SUCCESS);
+    munit_assert_size(ttl_map_expire(map, 0), ==, 0);
+    munit_assert_size(ttl_map_size(map), ==, 1);
+    ttl_map_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitResult test_touch_and_replace(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    ttl_map_t *map = _test_ttl_create(0);
+    munit_assert_int(ttl_map_insert(map, "a", "1", 10, 0), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_touch(map, "a", 100, 5), ==, MAP_SUCCESS);
+    munit_assert_size(ttl_map_expire(map, 104), ==, 0);
+    munit_assert_size(ttl_map_expire(map, 105), ==, 1);
+    munit_assert_int(ttl_map_touch(map, "a", 100, 105), ==, MAP_KEY_NOT_FOUND);
+
+    // Replacing resets the expiry, even to an earlier time
+    munit_assert_int(ttl_map_insert(map, "b", "1", 1000, 200), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_insert(map, "b", "2", 1, 200), ==, MAP_SUCCESS);
+    munit_assert_string_equal((const char *)ttl_map_get(map, "b", 200), "2");
+    munit_assert_size(ttl_map_expire(map, 201), ==, 1);
+    ttl_map_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitResult test_binary_keys(const MunitParameter params[], void *data) {
+    (void)params;
+    (void)data;
+    ttl_map_t *map = _test_ttl_create(0);
+    // Differ only after an embedded NUL
+    static char key_a[] = { 'k', '\0', 'a' };
+    static char key_b[] = { 'k', '\0', 'b' };
+    munit_assert_int(ttl_map_insert_n(map, key_a, sizeof(key_a), "a", 10, 0), ==, MAP_SUCCESS);
+    munit_assert_int(ttl_map_insert_n(map, key_b, sizeof(key_b), "b", 20, 0), ==, MAP_SUCCESS);
+    munit_assert_size(ttl_map_size(map), ==, 2);
+    munit_assert_null(ttl_map_get(map, "k", 0));
+
+    munit_assert_size(ttl_map_expire(map, 10), ==, 1);
+    munit_assert_false(ttl_map_contains_n(map, key_a, sizeof(key_a), 10));
+    munit_assert_string_equal((const char *)ttl_map_get_n(map, key_b, sizeof(key_b), 10), "b");
+    munit_assert_int(ttl_map_delete_n(map, key_b, sizeof(key_b)), ==, MAP_SUCCESS);
+    ttl_map_destroy(map);
+    return MUNIT_OK;
+}
+
+static MunitTest tests[] = {
+    { (char *)"/expires-at-deadline", test_expires_at_deadline, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/zero-ttl", test_zero_ttl, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/level-boundaries", test_level_boundaries, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/end-of-time", test_end_of_time, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/long-jump", test_long_jump, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/touch-and-replace", test_touch_and_replace, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/binary-keys", test_binary_keys, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+};
+
+static const MunitSuite suite = { (char *)"/ttl_map", tests, NULL, 1, MUNIT_SUITE_OPTION_NONE };
+
+int main(int argc, char *argv[]) {
+    return munit_suite_main(&suite, NULL, argc, argv);
+}